@@ -29,26 +29,54 @@ uint64_t total_RTC_cycles = 0;
 
 void BLE_Sleep_App(void)
 {
+    /* Ramp the clock up while the BLE kernel has work to do, a clock raised
+     * by the tasks is kept for the commands they queued */
+    if (BLE_Baseband_Is_Awake() && ke_event_get_all())
+    {
+        Clock_Request(CLOCK_USER_BLE, CLOCK_BLE_LEVEL);
+    }
+
+    /* Lower the clock left by the tasks when the kernel is idle */
+    Clock_Idle();
+
     if (BLE_Baseband_Is_Awake())
     {
+        /* Queue due notifications on this wakeup for the next connection events */
+        CUSTOMSS_NotifyPoll();
+
         BLE_Kernel_Process();
 
+        /* Back to CLOCK_LEVEL_LOW before the logs are sent and before sleep */
+        Clock_Request(CLOCK_USER_BLE, CLOCK_LEVEL_LOW);
+        Clock_Idle();
+
+        /* Send pending logs while the UART interrupt can still run */
+        Trace_Flush();
+
+        /* Send deferred log records by DMA once the text logs are out */
+        TraceLog_Drain();
+
         /* Checks for sleep have to be done with interrupt disabled */
         GLOBAL_INT_DISABLE();
 
+        /* Limit BLE sleep to the next scheduler deadline */
+        SleepCoord_Prepare(&ble_sleep_api_param);
+
         /* Check if processor clock can be gated */
         switch (BLE_Baseband_Sleep(&ble_sleep_api_param))
         {
             case RWIP_DEEP_SLEEP:
             {
-                SOC_Sleep();
+                /* Select the cheapest power mode for the time left before
+                 * the next deadline, stay in WFI while the DMA sends logs */
+                SleepPolicy_Enter(SleepPolicy_Select(!TraceLog_Busy()));
                 break;
             }
 
             case RWIP_CPU_SLEEP:
             {
                 /* Wait for interrupt */
-                __WFI();
+                SleepPolicy_Enter(SLEEP_POLICY_WFI);
                 break;
             }
 
@@ -67,8 +95,12 @@ void BLE_Sleep_App(void)
     }
     else
     {
+        /* Logs of the RTC wakeup are sent while the core waits */
+        Trace_Flush();
+        TraceLog_Drain();
+
         /* Wait for interrupt */
-        __WFI();
+        SleepPolicy_Enter(SLEEP_POLICY_WFI);
     }
 }
 
@@ -80,7 +112,7 @@ int main()
     /* Configure clocks, GPIOs, trace interface and load calibration data */
     DeviceInit();
 
-    swmLogInfo("__ble_rtc_scheduler has started..\r\n");
+    APP_LOG_INFO("__ble_rtc_scheduler has started..\r\n");
 
     /* Initialize the Kernel and create application task */
     BLEStackInit();
@@ -88,6 +120,15 @@ int main()
     /* Subscribe application callback handlers to BLE events */
     AppMsgHandlersInit();
 
+    /* Add the statistics of each module to the periodic report */
+    AppStatsReportInit();
+
+    /* Start with the default advertising window */
+    AdvPolicy_Initialize();
+
+    /* Load the IRKs of the bond list in RAM */
+    BondCache_Init();
+
     /* Prepare advertising and scan response data (device name + company ID) */
     PrepareAdvScanData();
 
@@ -124,14 +165,23 @@ void Main_Loop()
             /* Clear flag for next wake up */
             wakeup_due_to_RTC = 0;
 
-            /* Initialize swmTrace after wake up from sleep */
-            Init_SWMTrace();
-
             /* Execute scheduler */
             Scheduler_Main();
 
             /* Print total elapsed RTC cycles for measurement */
             Print_Time_Info(total_RTC_cycles);
+
+            /* Dump wakeup phase histograms from time to time */
+            Profiler_Log_Periodic();
+
+            /* Dump power state transitions for tools/power_trace_analyzer.py */
+            PowerRec_Dump_Periodic();
+
+            /* Dump heap peaks for tools/heap_profile.py */
+            HeapProfile_Dump_Periodic();
+
+            /* Log module statistics, one module per wakeup */
+            StatsReport_Periodic();
         }
     }
 }
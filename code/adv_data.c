@@ -0,0 +1,162 @@
+/**
+ * @file adv_data.c
+ * @brief Advertising data builder source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <string.h>
+
+extern uint8_t app_adv_data[ADV_DATA_LEN], app_scan_rsp_data[ADV_DATA_LEN];
+extern uint8_t app_adv_data_len, app_scan_rsp_data_len;
+
+static const struct
+{
+    uint8_t offset;
+    uint8_t size;
+} adv_data_slot[ADV_DATA_SLOT_NB] =
+{
+    [ADV_DATA_SLOT_BATTERY] = { ADV_DATA_BATTERY_OFFSET, ADV_DATA_BATTERY_SIZE },
+    [ADV_DATA_SLOT_COUNTER] = { ADV_DATA_COUNTER_OFFSET, ADV_DATA_COUNTER_SIZE }
+};
+
+static uint8_t adv_data_air[ADV_DATA_LEN];  /**< Data last given to the stack */
+static uint8_t adv_data_slots = 0;          /**< Offset of the slots in app_adv_data, 0 if not present */
+static uint8_t adv_data_actv_idx = 0;
+static bool adv_data_created = false;       /**< Activity exists, updates can be sent */
+static bool adv_data_busy = false;          /**< Data of the activity being set */
+static bool adv_data_initial = false;       /**< The update in progress is the data of a new activity */
+static adv_data_stats_t adv_data_stats;
+
+void AdvData_Build(void)
+{
+    uint8_t devName[] = APP_DEVICE_NAME;
+    uint8_t manuData[APP_COMPANY_ID_LEN + ADV_DATA_SLOTS_LEN] = APP_COMPANY_ID;
+
+    /* Assemble advertising data as device name + company ID + slots */
+    app_adv_data_len = 0;
+    GAP_AddAdvData(APP_DEVICE_NAME_LEN + 1, GAP_AD_TYPE_COMPLETE_NAME,
+                   devName, app_adv_data, &app_adv_data_len);
+
+    if ((app_adv_data_len + 2 + sizeof(manuData)) > ADV_DATA_MAX_LEN)
+    {
+        APP_LOG_ERROR("AdvData: %d bytes left, slots not advertised\r\n",
+                      ADV_DATA_MAX_LEN - app_adv_data_len);
+        adv_data_slots = 0;
+        return;
+    }
+
+    /* Slots follow the length, type and company ID fields */
+    adv_data_slots = app_adv_data_len + 2 + APP_COMPANY_ID_LEN;
+    GAP_AddAdvData(sizeof(manuData) + 1, GAP_AD_TYPE_MANU_SPECIFIC_DATA,
+                   manuData, app_adv_data, &app_adv_data_len);
+}
+
+void AdvData_Set_Slot(adv_data_slot_t slot, uint32_t value)
+{
+    if ((slot >= ADV_DATA_SLOT_NB) || (adv_data_slots == 0))
+    {
+        return;
+    }
+
+    uint8_t *p = &app_adv_data[adv_data_slots + adv_data_slot[slot].offset];
+
+    for (uint8_t i = 0; i < adv_data_slot[slot].size; i++)
+    {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    AdvData_Push();
+}
+
+void AdvData_Push(void)
+{
+    /* New values are picked up when the previous update completes */
+    if (!adv_data_created || adv_data_busy)
+    {
+        return;
+    }
+
+    if (!memcmp(adv_data_air, app_adv_data, app_adv_data_len))
+    {
+        adv_data_stats.unchanged++;
+        return;
+    }
+
+    memcpy(adv_data_air, app_adv_data, app_adv_data_len);
+    adv_data_busy = true;
+
+    /* The activity keeps running, the new data is used from the next
+     * advertising event */
+    GAPM_SetAdvDataCmd(GAPM_SET_ADV_DATA, adv_data_actv_idx,
+                       app_adv_data_len, app_adv_data);
+    adv_data_stats.updates++;
+}
+
+void AdvData_Activity_Created(uint8_t actv_idx)
+{
+    adv_data_actv_idx = actv_idx;
+    adv_data_created = true;
+    memcpy(adv_data_air, app_adv_data, app_adv_data_len);
+
+    /* Slots written before this completes are pushed afterwards, one
+     * GAPM_SET_ADV_DATA in flight at a time */
+    adv_data_busy = true;
+    adv_data_initial = true;
+
+    GAPM_SetAdvDataCmd(GAPM_SET_SCAN_RSP_DATA, actv_idx,
+                       app_scan_rsp_data_len, app_scan_rsp_data);
+    GAPM_SetAdvDataCmd(GAPM_SET_ADV_DATA, actv_idx,
+                       app_adv_data_len, app_adv_data);
+}
+
+bool AdvData_Complete(uint8_t status)
+{
+    bool live = !adv_data_initial;
+
+    if (!adv_data_busy)
+    {
+        return false;
+    }
+
+    adv_data_busy = false;
+    adv_data_initial = false;
+
+    if (status != GAP_ERR_NO_ERROR)
+    {
+        /* Activity is being re-created or was deleted, the data is sent
+         * again with the new activity */
+        adv_data_stats.errors++;
+        memset(adv_data_air, 0, sizeof(adv_data_air));
+        return live;
+    }
+
+    /* Send values written while this update was in progress */
+    AdvData_Push();
+
+    return live;
+}
+
+const adv_data_stats_t * AdvData_Get_Stats(void)
+{
+    return &adv_data_stats;
+}
+
+void AdvData_Log_Stats(void)
+{
+    const adv_data_stats_t *a = AdvData_Get_Stats();
+
+    TRACE_LOG("STAT advdata updates=%lu unchanged=%lu errors=%lu\r\n",
+              a->updates, a->unchanged, a->errors);
+}
@@ -0,0 +1,202 @@
+/**
+ * @file adv_policy.c
+ * @brief Advertising policy source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+
+extern GAPM_ActivityStatus_t advActivityStatus;
+extern struct gapm_adv_create_param advParam;
+
+static adv_policy_decision_t adv_decision;
+static adv_policy_stats_t adv_stats;
+
+static uint64_t adv_last_connection = 0;    /**< Last connection or disconnection (RTC cycles) */
+static uint8_t adv_attempts = 0;            /**< Recent connections, halved every window */
+static uint8_t adv_quiet_backoff = 0;       /**< Off time doublings at a quiet site */
+static uint64_t adv_window_start = 0;       /**< Start of current window (RTC cycles) */
+static uint16_t adv_interval_pending = 0;   /**< Interval of the activity being re-created */
+
+/**
+ * @brief Delete the advertising activity, it is re-created with the new
+ *        interval once deleted.
+ */
+static void AdvPolicy_Set_Interval(uint16_t interval)
+{
+    struct gapm_activity_delete_cmd *cmd;
+
+    adv_interval_pending = interval;
+
+    cmd = KE_MSG_ALLOC(GAPM_ACTIVITY_DELETE_CMD, TASK_GAPM, TASK_APP,
+                       gapm_activity_delete_cmd);
+    cmd->operation = GAPM_DELETE_ACTIVITY;
+    cmd->actv_idx = advActivityStatus.actv_idx;
+    ke_msg_send(cmd);
+
+    adv_stats.interval_changes++;
+}
+
+void AdvPolicy_Initialize(void)
+{
+    adv_decision.on_s = ADV_POLICY_ON_S;
+    adv_decision.off_s = ADV_POLICY_OFF_S;
+    adv_decision.interval = APP_ADV_INT_MIN;
+    adv_stats.last = adv_decision;
+}
+
+const adv_policy_decision_t * AdvPolicy_Evaluate(void)
+{
+    uint32_t since_s = (uint32_t)((RTC_Get_Timestamp() - adv_last_connection) / 32768);
+    uint8_t battery = APP_BASS_GetCachedBatteryLevel();
+    uint32_t off_s = ADV_POLICY_OFF_S;
+
+    adv_decision.on_s = ADV_POLICY_ON_S;
+    adv_decision.interval = APP_ADV_INT_MIN;
+
+    if (adv_attempts || ((adv_stats.connections != 0) && (since_s < ADV_POLICY_RECENT_S)))
+    {
+        /* Busy site */
+        adv_decision.on_s = ADV_POLICY_BUSY_ON_S;
+        off_s = ADV_POLICY_BUSY_OFF_S;
+        adv_quiet_backoff = 0;
+    }
+    else if (since_s >= ADV_POLICY_QUIET_S)
+    {
+        /* Quiet site, back off a little more every window */
+        off_s = (uint32_t)ADV_POLICY_OFF_S << adv_quiet_backoff;
+        if (off_s < ADV_POLICY_OFF_MAX_S)
+        {
+            adv_quiet_backoff++;
+        }
+        adv_decision.interval = ADV_POLICY_SLOW_INTERVAL;
+    }
+
+    /* A bonded peer is expected to come back */
+    if ((BondCache_Size() > 0) && (off_s > ADV_POLICY_BONDED_OFF_MAX_S))
+    {
+        off_s = ADV_POLICY_BONDED_OFF_MAX_S;
+    }
+
+    if (battery <= ADV_POLICY_BATT_CRITICAL)
+    {
+        adv_decision.on_s = ADV_POLICY_ON_MIN_S;
+        off_s = ADV_POLICY_OFF_MAX_S;
+        adv_decision.interval = ADV_POLICY_SLOW_INTERVAL;
+    }
+    else if (battery <= ADV_POLICY_BATT_LOW)
+    {
+        off_s *= 2;
+        adv_decision.interval = ADV_POLICY_SLOW_INTERVAL;
+    }
+
+    /* Scheduler tasks wait at most SCHEDULER_MAX_BURST_TIME */
+    adv_decision.off_s = (off_s < ADV_POLICY_OFF_MAX_S) ? off_s : ADV_POLICY_OFF_MAX_S;
+
+    return &adv_decision;
+}
+
+uint16_t AdvPolicy_Window(bool window_on)
+{
+    if (window_on)
+    {
+        const adv_policy_decision_t *d = AdvPolicy_Evaluate();
+
+        adv_stats.last = *d;
+        adv_attempts >>= 1;
+
+        if ((d->interval != advParam.prim_cfg.adv_intv_min) && (adv_interval_pending == 0))
+        {
+            /* Advertising starts once the activity is re-created */
+            AdvPolicy_Set_Interval(d->interval);
+        }
+        else
+        {
+            ControlBLEAdvActivity(true);
+        }
+
+        adv_stats.windows++;
+        adv_window_start = RTC_Get_Timestamp();
+
+        return d->on_s;
+    }
+
+    ControlBLEAdvActivity(false);
+
+    if (adv_window_start)
+    {
+        adv_stats.adv_cycles += RTC_Get_Timestamp() - adv_window_start;
+        adv_window_start = 0;
+    }
+
+    return adv_decision.off_s;
+}
+
+void AdvPolicy_On_Connection(void)
+{
+    adv_last_connection = RTC_Get_Timestamp();
+    adv_stats.connections++;
+
+    if (adv_attempts < UINT8_MAX)
+    {
+        adv_attempts++;
+    }
+}
+
+void AdvPolicy_On_Disconnection(void)
+{
+    adv_last_connection = RTC_Get_Timestamp();
+}
+
+void AdvPolicy_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                          ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    const struct gapm_cmp_evt *p = param;
+
+    if ((msg_id != GAPM_CMP_EVT) || (p->operation != GAPM_DELETE_ACTIVITY) ||
+        (adv_interval_pending == 0))
+    {
+        return;
+    }
+
+    if (p->status == GAP_ERR_NO_ERROR)
+    {
+        /* Same flow as the first creation: GAPM_ACTIVITY_CREATED_IND sets
+         * the advertising data, then advertising is started */
+        advParam.prim_cfg.adv_intv_min = adv_interval_pending;
+        advParam.prim_cfg.adv_intv_max = adv_interval_pending;
+        GAPM_ActivityCreateAdvCmd(&advActivityStatus, GAPM_STATIC_ADDR, &advParam);
+    }
+    else
+    {
+        /* Keep the current interval */
+        ControlBLEAdvActivity(true);
+    }
+
+    adv_interval_pending = 0;
+}
+
+const adv_policy_stats_t * AdvPolicy_Get_Stats(void)
+{
+    return &adv_stats;
+}
+
+void AdvPolicy_Log_Stats(void)
+{
+    const adv_policy_stats_t *a = AdvPolicy_Get_Stats();
+
+    TRACE_LOG("STAT advpol windows=%lu conn=%lu intv_changes=%lu adv_ms=%lu on=%u off=%u intv=%u\r\n",
+              a->windows, a->connections, a->interval_changes, STATS_REPORT_MS(a->adv_cycles),
+              a->last.on_s, a->last.off_s, a->last.interval);
+}
@@ -20,6 +20,104 @@
 #include <swmTrace_api.h>
 #include <ble_bass.h>
 
+/* Last measured battery level, 100% until the first measurement */
+static uint8_t battLevelCached = 100;
+
+/* Running average of the LSAD samples times APP_BASS_AVG_NB, 0 before the
+ * first sample */
+static uint32_t battLsadSum = 0;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t APP_BASS_LsadToPercent(uint32_t lsad)
+ * ----------------------------------------------------------------------------
+ * Description   : Convert an LSAD battery reading to a level in a scale of
+ *                 [0,100], where 0% = 1.1V and 100% = 1.4V.
+ * Inputs        : lsad             - Trimmed LSAD reading of VBAT/2
+ * Outputs       : An integer in the [0,100] range.
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint8_t APP_BASS_LsadToPercent(uint32_t lsad)
+{
+    uint32_t percent;
+
+    if (lsad <= VBAT_1p1V_MEASURED)
+    {
+        return 0;
+    }
+
+    percent = ((lsad - VBAT_1p1V_MEASURED) * 100) /
+              (VBAT_1p4V_MEASURED - VBAT_1p1V_MEASURED);
+
+    return (percent <= 100) ? (uint8_t)percent : 100;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void APP_BASS_SetLevel(uint8_t level)
+ * ----------------------------------------------------------------------------
+ * Description   : Keep a new battery level and advertise it, the advertising
+ *                 data is only sent if the byte changed.
+ * Inputs        : level            - Battery level in the [0,100] range
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void APP_BASS_SetLevel(uint8_t level)
+{
+    battLevelCached = level;
+    AdvData_Set_Slot(ADV_DATA_SLOT_BATTERY, level);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void APP_BASS_Init(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Configure the LSAD battery monitor channel to measure
+ *                 VBAT/2 against ground. The LSAD converts continuously at
+ *                 its slowest rate, a measurement only reads the last
+ *                 conversion.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called after the calibration, which also uses the LSAD
+ * ------------------------------------------------------------------------- */
+void APP_BASS_Init(void)
+{
+    LSAD->INPUT_SEL[LSAD_BATMON_CH] = (LSAD_POS_INPUT_VBAT_DIV2 | LSAD_NEG_INPUT_GND);
+    LSAD->CFG = (VBAT_DIV2_ENABLE | LSAD_NORMAL | LSAD_PRESCALE_1280H);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t APP_BASS_MeasureBatteryLevel(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Add the last LSAD conversion to the running average of the
+ *                 battery level and advertise the level. Does not wait,
+ *                 called from the scheduler tasks so the level follows the
+ *                 battery without a dedicated wakeup.
+ * Inputs        : None
+ * Outputs       : An integer in the [0,100] range.
+ * Assumptions   : APP_BASS_Init() was called
+ * ------------------------------------------------------------------------- */
+uint8_t APP_BASS_MeasureBatteryLevel(void)
+{
+    uint32_t sample = LSAD->DATA_TRIM_CH[LSAD_BATMON_CH];
+
+    /* No conversion yet after a reset of the LSAD */
+    if (sample == 0)
+    {
+        return battLevelCached;
+    }
+
+    if (battLsadSum == 0)
+    {
+        battLsadSum = sample * APP_BASS_AVG_NB;
+    }
+    else
+    {
+        battLsadSum += sample - (battLsadSum / APP_BASS_AVG_NB);
+    }
+
+    APP_BASS_SetLevel(APP_BASS_LsadToPercent(battLsadSum / APP_BASS_AVG_NB));
+
+    return battLevelCached;
+}
+
 /* ----------------------------------------------------------------------------
  * Function      : void APP_BASS_ReadBatteryLevel(uint8_t bas_nb)
  * ----------------------------------------------------------------------------
@@ -41,17 +139,29 @@ uint8_t APP_BASS_ReadBatteryLevel(uint8_t bas_nb)
         lsad_avg += LSAD->DATA_TRIM_CH[LSAD_BATMON_CH];
 
         /* 5ms delay */
-        Sys_Delay((uint32_t)(0.005 * SystemCoreClock));
+        Sys_Delay(SystemCoreClock / 200);
     }
 
     lsad_avg = lsad_avg >> 4;    /* Average 16 reads */
 
     /* Calculate percentage battery level */
-    battLevelPercent = (uint8_t)(((lsad_avg - VBAT_1p1V_MEASURED) * 100) /
-                                 (VBAT_1p4V_MEASURED - VBAT_1p1V_MEASURED));
-
-    battLevelPercent = (battLevelPercent <= 100) ? battLevelPercent : 100;
+    battLevelPercent = APP_BASS_LsadToPercent(lsad_avg);
+    APP_BASS_SetLevel(battLevelPercent);
 
-    swmLogInfo("Read battery level = %d%%\r\n", battLevelPercent);
+    APP_LOG_INFO("Read battery level = %d%%\r\n", battLevelPercent);
     return battLevelPercent;
 }
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t APP_BASS_GetCachedBatteryLevel(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Return the averaged battery level without performing a
+ *                 new measurement.
+ * Inputs        : None
+ * Outputs       : An integer in the [0,100] range.
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t APP_BASS_GetCachedBatteryLevel(void)
+{
+    return battLevelCached;
+}
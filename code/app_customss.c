@@ -15,11 +15,17 @@
  * @endparblock
  */
 
+#define APP_LOG_MODULE                  CUSTOMSS
+
 #include <ble_abstraction.h>
 #include <string.h>
 #include <swmTrace_api.h>
+#include <app_trace.h>
+#include <trace_log.h>
 #include <app_customss.h>
-#include <stdio.h>
+#include <wakeup_source_config.h>
+#include <conn_policy.h>
+#include <app_dispatch.h>
 
 /* Global variable definition */
 static struct app_env_tag_cs app_env_cs;
@@ -35,10 +41,11 @@ static const struct att_db_desc att_db[] =
                      CS_CHAR_TX_UUID,
                      PERM(RD, ENABLE) | PERM(NTF, ENABLE),
                      sizeof(app_env_cs.to_air_buffer),
-                     app_env_cs.to_air_buffer, NULL),
+                     app_env_cs.to_air_buffer,
+                     CUSTOMSS_TXCharCallback),
     CS_CHAR_CCC(CS_TX_VALUE_CCC0,
                 app_env_cs.to_air_cccd_value,
-                NULL),
+                CUSTOMSS_CCCCallback),
     CS_CHAR_USER_DESC(CS_TX_VALUE_USR_DSCP0,
                       sizeof(CS_TX_CHAR_NAME) - 1,
                       CS_TX_CHAR_NAME,
@@ -54,7 +61,7 @@ static const struct att_db_desc att_db[] =
                      CUSTOMSS_RXCharCallback),
     CS_CHAR_CCC(CS_RX_VALUE_CCC0,
                 app_env_cs.from_air_cccd_value,
-                NULL),
+                CUSTOMSS_CCCCallback),
     CS_CHAR_USER_DESC(CS_RX_VALUE_USR_DSCP0,
                       sizeof(CS_RX_CHAR_NAME) - 1,
                       CS_RX_CHAR_NAME,
@@ -67,10 +74,10 @@ static const struct att_db_desc att_db[] =
                      PERM(RD, ENABLE) | PERM(NTF, ENABLE),
                      sizeof(app_env_cs.to_air_buffer_long),
                      app_env_cs.to_air_buffer_long,
-                     NULL),
+                     CUSTOMSS_TXLongCharCallback),
     CS_CHAR_CCC(CS_TX_LONG_VALUE_CCC0,
                 app_env_cs.to_air_cccd_value_long,
-                NULL),
+                CUSTOMSS_CCCCallback),
     CS_CHAR_USER_DESC(CS_TX_LONG_VALUE_USR_DSCP0,
                       sizeof(CS_TX_CHAR_LONG_NAME) - 1,
                       CS_TX_CHAR_LONG_NAME,
@@ -91,64 +98,804 @@ static const struct att_db_desc att_db[] =
     /* Client Characteristic Configuration descriptor */
     CS_CHAR_CCC(CS_RX_LONG_VALUE_CCC0,              /* attidx */
                 app_env_cs.from_air_cccd_value_long,    /* data */
-                NULL),                              /* callback */
+                CUSTOMSS_CCCCallback),              /* callback */
     /* Characteristic User Description descriptor */
     CS_CHAR_USER_DESC(CS_RX_LONG_VALUE_USR_DSCP0,    /* attidx */
                       sizeof(CS_RX_CHAR_LONG_NAME) - 1,    /* length */
                       CS_RX_CHAR_LONG_NAME,         /* data */
                       NULL),                        /* callback */
+
+    /* Wakeup profiler diagnostics */
+    CS_CHAR_UUID_128(CS_DIAG_VALUE_CHAR0,
+                     CS_DIAG_VALUE_VAL0,
+                     CS_CHAR_DIAG_UUID,
+                     PERM(RD, ENABLE) | PERM(WRITE_REQ, ENABLE),
+                     sizeof(app_env_cs.diag_buffer),
+                     app_env_cs.diag_buffer,
+                     CUSTOMSS_DiagCharCallback),
+    CS_CHAR_USER_DESC(CS_DIAG_VALUE_USR_DSCP0,
+                      sizeof(CS_DIAG_CHAR_NAME) - 1,
+                      CS_DIAG_CHAR_NAME,
+                      NULL),
+
+    /* Stream, enabling notifications starts the stream */
+    CS_CHAR_UUID_128(CS_STREAM_VALUE_CHAR0,
+                     CS_STREAM_VALUE_VAL0,
+                     CS_CHAR_STREAM_UUID,
+                     PERM(RD, ENABLE) | PERM(NTF, ENABLE),
+                     sizeof(app_env_cs.stream_buffer),
+                     app_env_cs.stream_buffer,
+                     NULL),
+    CS_CHAR_CCC(CS_STREAM_VALUE_CCC0,
+                app_env_cs.stream_cccd_value,
+                CUSTOMSS_StreamCCCCallback),
+    CS_CHAR_USER_DESC(CS_STREAM_VALUE_USR_DSCP0,
+                      sizeof(CS_STREAM_CHAR_NAME) - 1,
+                      CS_STREAM_CHAR_NAME,
+                      NULL),
+};
+
+static uint32_t notifyOnTimeout;
+static uint8_t val_notif = 0;
+
+/* Per link custom service state, the att_db buffers of the CCC descriptors
+ * and RX values are only used to exchange data with the stack */
+struct cs_link_env
+{
+    uint8_t ccc[CS_CCC_NB];                 /* Low byte of each CCC value */
+    uint8_t from_air_length;
+    uint8_t from_air_buffer[CS_VALUE_MAX_LENGTH];
+    uint8_t from_air_buffer_long[CS_LONG_VALUE_MAX_LENGTH];    /* TX long value is its complement */
+    bool ind_in_flight;                     /* RX long value indication not confirmed yet */
+    bool ind_pending;                       /* Newer RX long value to indicate */
+    uint8_t ind_retries;                    /* Failed sends of the pending value */
+    uint64_t ind_queued;                    /* Pending value queued at (RTC cycles) */
+    uint64_t ind_sent_queued;               /* In flight value queued at (RTC cycles) */
+    cs_ind_stats_t ind_stats;
+};
+
+static struct cs_link_env cs_link[APP_MAX_NB_CON];
+
+/* Per connection stream state */
+struct cs_stream_env
+{
+    bool enabled;
+    bool stalled;                           /* Out of credits, counted once per stall */
+    uint8_t in_flight;
+    uint16_t mtu;
+    uint16_t tx_octets;
+    uint32_t pattern_offset;
+    cs_stream_stats_t stats;
 };
 
-static uint32_t notifyOnTimeout;
-static uint8_t val_notif = 0;
+static struct cs_stream_env stream_env[APP_MAX_NB_CON];
+static uint8_t stream_credits = APP_STREAM_CREDITS;
+static cs_stream_source_t stream_source = NULL;
+
+#if (CUSTOMSS_NTF_COALESCE == 1)
+/* RTC timestamp of the next notification pass */
+static uint64_t notifyDue;
+
+/* Convert the kernel timer setting (ms) to RTC cycles */
+#define CUSTOMSS_NTF_MS_TO_RTC(x)    (((uint64_t)(x) * 32768) / 1000)
+#endif    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+
+const struct att_db_desc * CUSTOMSS_GetDatabaseDescription(void)
+{
+    return att_db;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void CUSTOMSS_LinkReset(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Restore the default state of a link, TX value
+ *                 notifications enabled, everything else disabled and the
+ *                 TX long value reading as zeros
+ * Inputs        : conidx       - Connection index
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void CUSTOMSS_LinkReset(uint8_t conidx)
+{
+    memset(&cs_link[conidx], 0, sizeof(cs_link[conidx]));
+    memset(cs_link[conidx].from_air_buffer_long, 0xFF, CS_LONG_VALUE_MAX_LENGTH);
+    cs_link[conidx].ccc[CS_CCC_TX] = ATT_CCC_START_NTF;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t CUSTOMSS_CCCIndex(uint16_t attidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Map a CCC descriptor attribute to its per link table entry
+ * Inputs        : attidx       - Attribute index in att_db
+ * Outputs       : Index in cs_link_env.ccc, CS_CCC_NB if not a CCC
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint8_t CUSTOMSS_CCCIndex(uint16_t attidx)
+{
+    switch (attidx)
+    {
+        case CS_TX_VALUE_CCC0:      return CS_CCC_TX;
+        case CS_RX_VALUE_CCC0:      return CS_CCC_RX;
+        case CS_TX_LONG_VALUE_CCC0: return CS_CCC_TX_LONG;
+        case CS_RX_LONG_VALUE_CCC0: return CS_CCC_RX_LONG;
+        case CS_STREAM_VALUE_CCC0:  return CS_CCC_STREAM;
+        default:                    return CS_CCC_NB;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint32_t CUSTOMSS_Subscribers(uint8_t ccc, uint8_t value)
+ * ----------------------------------------------------------------------------
+ * Description   : Links that enabled a CCC value
+ * Inputs        : - ccc        - CS_CCC_TX, CS_CCC_RX_LONG, ...
+ *                 - value      - ATT_CCC_START_NTF or ATT_CCC_START_IND
+ * Outputs       : NTF_QUEUE_CON() bits of the subscribed active links
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint32_t CUSTOMSS_Subscribers(uint8_t ccc, uint8_t value)
+{
+    uint32_t con_mask = 0;
+
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        if ((cs_link[i].ccc[ccc] & value) && GAPC_IsConnectionActive(i))
+        {
+            con_mask |= NTF_QUEUE_CON(i);
+        }
+    }
+
+    return con_mask;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_Initialize(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Initialize custom service environment
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_Initialize(void)
+{
+    memset(&app_env_cs, '\0', sizeof(struct app_env_tag_cs));
+
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        CUSTOMSS_LinkReset(i);
+    }
+
+    notifyOnTimeout = 0;
+
+    AppDispatch_Add(GATTM_ADD_SVC_RSP, CUSTOMSS_MsgHandler);
+    AppDispatch_Add(CUSTOMSS_NTF_TIMEOUT, CUSTOMSS_MsgHandler);
+    AppDispatch_Add_Op(GATTC_CMP_EVT, GATTC_NOTIFY, CUSTOMSS_MsgHandler);
+    AppDispatch_Add_Op(GATTC_CMP_EVT, GATTC_INDICATE, CUSTOMSS_MsgHandler);
+    AppDispatch_Add(GATTC_MTU_CHANGED_IND, CUSTOMSS_MsgHandler);
+    AppDispatch_Add(GAPC_LE_PKT_SIZE_IND, CUSTOMSS_MsgHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, CUSTOMSS_MsgHandler);
+
+    NtfQueue_Init();
+
+    memset(stream_env, 0, sizeof(stream_env));
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        stream_env[i].mtu = CS_STREAM_DEFAULT_MTU;
+        stream_env[i].tx_octets = CS_STREAM_DEFAULT_TX_OCTETS;
+    }
+    stream_credits = APP_STREAM_CREDITS;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void CUSTOMSS_NotifyConnections(uint32_t con_mask)
+ * ----------------------------------------------------------------------------
+ * Description   : Queue the periodic notifications/indications to the
+ *                 peers of the mask. Each value is written once in a pool
+ *                 message shared by all subscribers, see NtfQueue_Send().
+ * Inputs        : con_mask     - NTF_QUEUE_CON() bits of the peers
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void CUSTOMSS_NotifyConnections(uint32_t con_mask)
+{
+    uint32_t ntf_mask = con_mask & CUSTOMSS_Subscribers(CS_CCC_TX, ATT_CCC_START_NTF);
+    uint8_t *buf;
+
+    if (ntf_mask)
+    {
+        buf = NtfQueue_Alloc();
+        if (buf != NULL)
+        {
+            /* Send notification to peer devices */
+            memset(buf, val_notif, CS_VALUE_MAX_LENGTH);
+            NtfQueue_Send(buf, CS_VALUE_MAX_LENGTH, GATTM_GetHandle(CUST_SVC0, CS_TX_VALUE_VAL0),
+                          GATTC_NOTIFY, ntf_mask);
+            APP_LOG_INFO("\n__CUSTOMSS notifying peer devices 0x%lx\r\n", ntf_mask);
+        }
+        val_notif++;
+    }
+
+    /* Each peer is notified of the RX long value it wrote last */
+    ntf_mask = con_mask & CUSTOMSS_Subscribers(CS_CCC_RX_LONG, ATT_CCC_START_NTF);
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        if ((ntf_mask & NTF_QUEUE_CON(i)) && ((buf = NtfQueue_Alloc()) != NULL))
+        {
+            memcpy(buf, cs_link[i].from_air_buffer_long, CS_LONG_VALUE_MAX_LENGTH);
+            NtfQueue_Send(buf, CS_LONG_VALUE_MAX_LENGTH, GATTM_GetHandle(CUST_SVC0, CS_RX_LONG_VALUE_VAL0),
+                          GATTC_NOTIFY, NTF_QUEUE_CON(i));
+        }
+    }
+
+    CUSTOMSS_IndicateLong(con_mask & CUSTOMSS_Subscribers(CS_CCC_RX_LONG, ATT_CCC_START_IND));
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void CUSTOMSS_IndicateSend(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Indicate the RX long value of a peer to it. Values
+ *                 written while it was pending are merged into this one.
+ * Inputs        : conidx       - Connection index
+ * Outputs       : None
+ * Assumptions   : No indication in flight on the link
+ * ------------------------------------------------------------------------- */
+static void CUSTOMSS_IndicateSend(uint8_t conidx)
+{
+    struct cs_link_env *link = &cs_link[conidx];
+
+    GATTC_SendEvtCmd(conidx, GATTC_INDICATE, CS_IND_SEQ_NUM,
+                     GATTM_GetHandle(CUST_SVC0, CS_RX_LONG_VALUE_VAL0),
+                     CS_LONG_VALUE_MAX_LENGTH, link->from_air_buffer_long);
+
+    link->ind_in_flight = true;
+    link->ind_pending = false;
+    link->ind_sent_queued = link->ind_queued;
+    link->ind_stats.sent++;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_IndicateLong(uint32_t con_mask)
+ * ----------------------------------------------------------------------------
+ * Description   : Queue an indication of their RX long value to the peers
+ *                 of the mask. Each peer has one indication in flight, the
+ *                 next one is sent when it is confirmed and carries the
+ *                 latest value.
+ * Inputs        : con_mask     - NTF_QUEUE_CON() bits of the peers
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_IndicateLong(uint32_t con_mask)
+{
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        struct cs_link_env *link = &cs_link[i];
+
+        if (!(con_mask & NTF_QUEUE_CON(i)))
+        {
+            continue;
+        }
+
+        link->ind_stats.queued++;
+
+        if (link->ind_pending)
+        {
+            link->ind_stats.merged++;
+        }
+        else
+        {
+            link->ind_pending = true;
+            link->ind_queued = RTC_Get_Timestamp();
+        }
+
+        if (link->ind_in_flight + link->ind_pending > link->ind_stats.max_depth)
+        {
+            link->ind_stats.max_depth = link->ind_in_flight + link->ind_pending;
+        }
+
+        if (!link->ind_in_flight)
+        {
+            CUSTOMSS_IndicateSend(i);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void CUSTOMSS_IndicateComplete(uint8_t conidx,
+ *                                                       uint8_t status)
+ * ----------------------------------------------------------------------------
+ * Description   : Account a confirmed indication and send the pending value.
+ *                 A failed indication is sent again up to CS_IND_RETRY_MAX
+ *                 times, while the link is up and the peer subscribed.
+ * Inputs        : conidx       - Connection index
+ *                 status       - GATTC_CMP_EVT status
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void CUSTOMSS_IndicateComplete(uint8_t conidx, uint8_t status)
+{
+    struct cs_link_env *link = &cs_link[conidx];
+
+    if (!link->ind_in_flight)
+    {
+        return;
+    }
+
+    link->ind_in_flight = false;
+
+    if (status == GAP_ERR_NO_ERROR)
+    {
+        uint32_t latency = (uint32_t)(RTC_Get_Timestamp() - link->ind_sent_queued);
+
+        link->ind_retries = 0;
+        link->ind_stats.confirmed++;
+        link->ind_stats.latency_last = latency;
+        if (latency > link->ind_stats.latency_max)
+        {
+            link->ind_stats.latency_max = latency;
+        }
+    }
+    else
+    {
+        link->ind_stats.failed++;
+
+        if ((status == GAP_ERR_DISCONNECTED) || !GAPC_IsConnectionActive(conidx) ||
+            !(link->ccc[CS_CCC_RX_LONG] & ATT_CCC_START_IND))
+        {
+            /* Nobody left to confirm it, a newer value is dropped too */
+            link->ind_stats.dropped += 1 + link->ind_pending;
+            link->ind_pending = false;
+            link->ind_retries = 0;
+            return;
+        }
+
+        if (link->ind_pending)
+        {
+            /* The newer value replaces the failed one */
+            link->ind_retries = 0;
+        }
+        else if (++link->ind_retries > CS_IND_RETRY_MAX)
+        {
+            link->ind_stats.dropped++;
+            link->ind_retries = 0;
+        }
+        else
+        {
+            link->ind_pending = true;
+            link->ind_queued = link->ind_sent_queued;
+        }
+    }
+
+    if (link->ind_pending)
+    {
+        CUSTOMSS_IndicateSend(conidx);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : const cs_ind_stats_t * CUSTOMSS_IndGetStats(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the RX long value indication statistics of a link
+ * Inputs        : conidx       - Connection index
+ * Outputs       : Pointer to statistics, NULL for an invalid index
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+const cs_ind_stats_t * CUSTOMSS_IndGetStats(uint8_t conidx)
+{
+    return (conidx < APP_MAX_NB_CON) ? &cs_link[conidx].ind_stats : NULL;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_IndLogStats(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Log the RX long value indications of each connection that
+ *                 indicated, one section of the statistics report
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_IndLogStats(void)
+{
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        const cs_ind_stats_t *ind = CUSTOMSS_IndGetStats(i);
+
+        if (ind->queued == 0)
+        {
+            continue;
+        }
+
+        TRACE_LOG("STAT ind %u queued=%lu merged=%lu sent=%lu confirmed=%lu failed=%lu dropped=%lu depth=%u last_ms=%lu max_ms=%lu\r\n",
+                  i, ind->queued, ind->merged, ind->sent, ind->confirmed, ind->failed,
+                  ind->dropped, ind->max_depth, STATS_REPORT_MS(ind->latency_last),
+                  STATS_REPORT_MS(ind->latency_max));
+    }
+}
+
+#if (CUSTOMSS_NTF_COALESCE == 1)
+/* ----------------------------------------------------------------------------
+ * Function      : static void CUSTOMSS_NotifyAll(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Notify every active connection in a single pass and arm
+ *                 the next one.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void CUSTOMSS_NotifyAll(void)
+{
+    uint32_t con_mask = 0;
+
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        if (GAPC_IsConnectionActive(i))
+        {
+            con_mask |= NTF_QUEUE_CON(i);
+        }
+    }
+
+    if (con_mask)
+    {
+        CUSTOMSS_NotifyConnections(con_mask);
+    }
+
+    /* Next pass at the first wakeup after notifyDue, the timer only wakes
+     * the device up if nothing else did */
+    notifyDue = RTC_Get_Timestamp() + CUSTOMSS_NTF_MS_TO_RTC(notifyOnTimeout);
+    ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, 0),
+                 notifyOnTimeout + CUSTOMSS_NTF_ALIGN_SLACK_MS);
+}
+#endif    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_NotifyOnTimeout(uint32_t timeout)
+ * ----------------------------------------------------------------------------
+ * Description   : Configure custom service to send periodic notifications.
+ * Inputs        : timeout       - in units of 10ms. If set to 0, periodic
+ *                                 notifications are disabled.
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_NotifyOnTimeout(uint32_t timeout)
+{
+    notifyOnTimeout = timeout;
+
+#if (CUSTOMSS_NTF_COALESCE == 1)
+    if (GATT_GetEnv()->cust_svc_db[0].cust_svc_start_hdl && timeout)
+    {
+        notifyDue = RTC_Get_Timestamp() + CUSTOMSS_NTF_MS_TO_RTC(timeout);
+        ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, 0),
+                     timeout + CUSTOMSS_NTF_ALIGN_SLACK_MS);
+    }
+#else    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        if (GATT_GetEnv()->cust_svc_db[0].cust_svc_start_hdl && timeout)
+        {
+            ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, i),
+                         timeout);
+        }
+    }
+#endif    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_NotifyPoll(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Run the notification pass if it is due, so it rides on the
+ *                 wakeup that is being processed instead of waking the
+ *                 device up on its own.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called on every wakeup, before the BLE kernel is processed
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_NotifyPoll(void)
+{
+#if (CUSTOMSS_NTF_COALESCE == 1)
+    if (notifyOnTimeout && (notifyDue != 0) && (GAPC_ConnectionCount() > 0) &&
+        (RTC_Get_Timestamp() >= notifyDue))
+    {
+        CUSTOMSS_NotifyAll();
+    }
+#endif    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint16_t CUSTOMSS_StreamPattern(uint8_t conidx,
+ *                                          uint8_t *buf, uint16_t max_len)
+ * ----------------------------------------------------------------------------
+ * Description   : Built-in stream source, an incrementing byte pattern of
+ *                 CS_STREAM_TEST_LENGTH bytes to measure throughput.
+ * Inputs        : - conidx     - Connection index
+ *                 - buf        - Destination buffer
+ *                 - max_len    - Size of buf
+ * Outputs       : Number of bytes written, 0 at the end of the pattern
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint16_t CUSTOMSS_StreamPattern(uint8_t conidx, uint8_t *buf, uint16_t max_len)
+{
+    struct cs_stream_env *env = &stream_env[conidx];
+    uint32_t left = CS_STREAM_TEST_LENGTH - env->pattern_offset;
+    uint16_t len = (left < max_len) ? (uint16_t)left : max_len;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)(env->pattern_offset + i);
+    }
+    env->pattern_offset += len;
+
+    return len;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint16_t CUSTOMSS_StreamPayloadSize(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Notification payload size for the connection. The whole
+ *                 ATT MTU is used when the ATT PDU fits in one LL PDU,
+ *                 otherwise the payload is trimmed so the last LL PDU is full.
+ * Inputs        : conidx       - Connection index
+ * Outputs       : Payload size in bytes
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint16_t CUSTOMSS_StreamPayloadSize(uint8_t conidx)
+{
+    const struct cs_stream_env *env = &stream_env[conidx];
+    uint16_t size;
+
+    /* 4 bytes L2CAP header and 3 bytes ATT header */
+    if ((env->mtu + 4) <= env->tx_octets)
+    {
+        size = env->mtu - 3;
+    }
+    else
+    {
+        size = ((env->mtu + 4) / env->tx_octets) * env->tx_octets - 7;
+    }
+
+    return (size < CS_STREAM_VALUE_MAX_LENGTH) ? size : CS_STREAM_VALUE_MAX_LENGTH;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void CUSTOMSS_StreamPump(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Queue stream notifications while credits are available.
+ *                 The stack copies the value into its message so
+ *                 stream_buffer is reused for every notification.
+ * Inputs        : conidx       - Connection index
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void CUSTOMSS_StreamPump(uint8_t conidx)
+{
+    struct cs_stream_env *env = &stream_env[conidx];
+    cs_stream_source_t source = stream_source ? stream_source : CUSTOMSS_StreamPattern;
+
+    /* A disconnecting link is stopped by GAPC_DISCONNECT_IND */
+    if (!env->enabled || !GAPC_IsConnectionActive(conidx))
+    {
+        return;
+    }
+
+    env->stats.payload = CUSTOMSS_StreamPayloadSize(conidx);
+
+    while (env->enabled && stream_credits)
+    {
+        uint16_t len = source(conidx, app_env_cs.stream_buffer, env->stats.payload);
+
+        if (len == 0)
+        {
+            /* End of data, in-flight notifications still complete */
+            env->enabled = false;
+            ConnPolicy_Set_Bulk(conidx, false);
+            PhyMgr_Set_Bulk(conidx, false);
+            APP_LOG_INFO("__CUSTOMSS stream %d done: %lu bytes, %lu B/s\r\n", conidx,
+                         env->stats.bytes, CUSTOMSS_StreamThroughput(conidx));
+            break;
+        }
+
+        GATTC_SendEvtCmd(conidx, GATTC_NOTIFY, CS_STREAM_SEQ_NUM,
+                         GATTM_GetHandle(CUST_SVC0, CS_STREAM_VALUE_VAL0),
+                         len, app_env_cs.stream_buffer);
+        stream_credits--;
+        env->in_flight++;
+        env->stalled = false;
+        env->stats.bytes += len;
+        PhyMgr_Add_Bytes(conidx, len);
+    }
+
+    if (env->enabled && !stream_credits && !env->stalled)
+    {
+        env->stalled = true;
+        env->stats.stalls++;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_StreamSetSource(cs_stream_source_t source)
+ * ----------------------------------------------------------------------------
+ * Description   : Set the function providing the stream data. NULL selects
+ *                 the built-in test pattern.
+ * Inputs        : source       - Stream source
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_StreamSetSource(cs_stream_source_t source)
+{
+    stream_source = source;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_StreamStart(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Start streaming to a peer. Requests the largest ATT MTU
+ *                 and LE data length, the payload grows as soon as the peer
+ *                 accepts them.
+ * Inputs        : conidx       - Connection index
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_StreamStart(uint8_t conidx)
+{
+    struct cs_stream_env *env;
+
+    if ((conidx >= APP_MAX_NB_CON) || !GAPC_IsConnectionActive(conidx))
+    {
+        return;
+    }
+
+    env = &stream_env[conidx];
+
+    if (env->mtu < APP_STREAM_MTU)
+    {
+        struct gattc_exc_mtu_cmd *cmd = KE_MSG_ALLOC(GATTC_EXC_MTU_CMD,
+                                                     KE_BUILD_ID(TASK_GATTC, conidx),
+                                                     TASK_APP, gattc_exc_mtu_cmd);
+        cmd->operation = GATTC_MTU_EXCH;
+        cmd->seq_num = 0;
+        ke_msg_send(cmd);
+    }
+
+    if (env->tx_octets < APP_STREAM_TX_OCTETS)
+    {
+        struct gapc_set_le_pkt_size_cmd *cmd = KE_MSG_ALLOC(GAPC_SET_LE_PKT_SIZE_CMD,
+                                                            KE_BUILD_ID(TASK_GAPC, conidx),
+                                                            TASK_APP, gapc_set_le_pkt_size_cmd);
+        cmd->operation = GAPC_SET_LE_PKT_SIZE;
+        cmd->tx_octets = APP_STREAM_TX_OCTETS;
+        cmd->tx_time = APP_STREAM_TX_TIME;
+        ke_msg_send(cmd);
+    }
+
+    memset(&env->stats, 0, sizeof(env->stats));
+    env->stats.start = RTC_Get_Timestamp();
+    env->stats.last = env->stats.start;
+    env->pattern_offset = 0;
+    env->stalled = false;
+    env->enabled = true;
+
+    /* Short connection interval and 2M PHY for the transfer */
+    ConnPolicy_Set_Bulk(conidx, true);
+    PhyMgr_Set_Bulk(conidx, true);
+
+    CUSTOMSS_StreamPump(conidx);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CUSTOMSS_StreamStop(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Stop streaming to a peer, in-flight notifications still
+ *                 complete and return their credits.
+ * Inputs        : conidx       - Connection index
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CUSTOMSS_StreamStop(uint8_t conidx)
+{
+    if ((conidx < APP_MAX_NB_CON) && stream_env[conidx].enabled)
+    {
+        stream_env[conidx].enabled = false;
+        ConnPolicy_Set_Bulk(conidx, false);
+        PhyMgr_Set_Bulk(conidx, false);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : const cs_stream_stats_t * CUSTOMSS_StreamGetStats(
+ *                                          uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the stream statistics of a connection
+ * Inputs        : conidx       - Connection index
+ * Outputs       : Pointer to statistics
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+const cs_stream_stats_t * CUSTOMSS_StreamGetStats(uint8_t conidx)
+{
+    return &stream_env[conidx].stats;
+}
 
-const struct att_db_desc * CUSTOMSS_GetDatabaseDescription(void)
+/* ----------------------------------------------------------------------------
+ * Function      : uint32_t CUSTOMSS_StreamThroughput(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Average stream throughput since the stream started
+ * Inputs        : conidx       - Connection index
+ * Outputs       : Throughput in bytes per second
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint32_t CUSTOMSS_StreamThroughput(uint8_t conidx)
 {
-    return att_db;
+    const cs_stream_stats_t *stats = &stream_env[conidx].stats;
+    uint64_t elapsed = stats->last - stats->start;
+
+    if (elapsed == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)stats->bytes * 32768) / elapsed);
 }
 
 /* ----------------------------------------------------------------------------
- * Function      : void CUSTOMSS_Initialize(void)
+ * Function      : void CUSTOMSS_StreamLogStats(void)
  * ----------------------------------------------------------------------------
- * Description   : Initialize custom service environment
+ * Description   : Log the stream statistics of each connection that
+ *                 streamed, one section of the statistics report
  * Inputs        : None
  * Outputs       : None
  * Assumptions   : None
  * ------------------------------------------------------------------------- */
-void CUSTOMSS_Initialize(void)
+void CUSTOMSS_StreamLogStats(void)
 {
-    memset(&app_env_cs, '\0', sizeof(struct app_env_tag_cs));
-
-    app_env_cs.to_air_cccd_value[0] = ATT_CCC_START_NTF;
-    app_env_cs.to_air_cccd_value[1] = 0x00;
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        const cs_stream_stats_t *st = CUSTOMSS_StreamGetStats(i);
 
-    notifyOnTimeout = 0;
+        if (st->bytes == 0)
+        {
+            continue;
+        }
 
-    MsgHandler_Add(GATTM_ADD_SVC_RSP, CUSTOMSS_MsgHandler);
-    MsgHandler_Add(CUSTOMSS_NTF_TIMEOUT, CUSTOMSS_MsgHandler);
-    MsgHandler_Add(GATTC_CMP_EVT, CUSTOMSS_MsgHandler);
+        TRACE_LOG("STAT stream %u bytes=%lu ntf=%lu err=%lu stalls=%lu payload=%u rate=%lu\r\n",
+                  i, st->bytes, st->notifications, st->errors, st->stalls,
+                  st->payload, CUSTOMSS_StreamThroughput(i));
+    }
 }
 
 /* ----------------------------------------------------------------------------
- * Function      : void CUSTOMSS_NotifyOnTimeout(uint32_t timeout)
+ * Function      : static void CUSTOMSS_StreamComplete(uint8_t conidx,
+ *                                                     uint8_t status)
  * ----------------------------------------------------------------------------
- * Description   : Configure custom service to send periodic notifications.
- * Inputs        : timeout       - in units of 10ms. If set to 0, periodic
- *                                 notifications are disabled.
+ * Description   : Return the credit of a completed stream notification and
+ *                 refill, starting with the next connection so streams
+ *                 share the credits.
+ * Inputs        : - conidx     - Connection index
+ *                 - status     - Completion status
  * Outputs       : None
  * Assumptions   : None
  * ------------------------------------------------------------------------- */
-void CUSTOMSS_NotifyOnTimeout(uint32_t timeout)
+static void CUSTOMSS_StreamComplete(uint8_t conidx, uint8_t status)
 {
-    notifyOnTimeout = timeout;
+    struct cs_stream_env *env = &stream_env[conidx];
 
-    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    /* Credits of a dropped link were already returned */
+    if (env->in_flight == 0)
     {
-        if (GATT_GetEnv()->cust_svc_db[0].cust_svc_start_hdl && timeout)
-        {
-            ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, i),
-                         timeout);
-        }
+        return;
+    }
+
+    env->in_flight--;
+    stream_credits++;
+    env->stats.last = RTC_Get_Timestamp();
+
+    if (status == GAP_ERR_NO_ERROR)
+    {
+        env->stats.notifications++;
+    }
+    else
+    {
+        env->stats.errors++;
+    }
+
+    for (uint8_t i = 1; i <= APP_MAX_NB_CON; i++)
+    {
+        CUSTOMSS_StreamPump((conidx + i) % APP_MAX_NB_CON);
     }
 }
 
@@ -179,60 +926,103 @@ void CUSTOMSS_MsgHandler(ke_msg_id_t const msg_id, void const *param,
             /* If service has been added successfully, start periodic notification timer */
             if (p->status == ATT_ERR_NO_ERROR && notifyOnTimeout)
             {
-                for (unsigned int i = 0; i < BLE_CONNECTION_MAX; i++)
+#if (CUSTOMSS_NTF_COALESCE == 1)
+                CUSTOMSS_NotifyOnTimeout(notifyOnTimeout);
+#else    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+                for (unsigned int i = 0; i < APP_MAX_NB_CON; i++)
                 {
                     ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, i),
                                  notifyOnTimeout);
                 }
+#endif    /* if (CUSTOMSS_NTF_COALESCE == 1) */
             }
         }
         break;
 
         case CUSTOMSS_NTF_TIMEOUT:
         {
+#if (CUSTOMSS_NTF_COALESCE == 1)
+            /* No other wakeup happened within the slack, notify now */
+            if (notifyOnTimeout)
+            {
+                CUSTOMSS_NotifyAll();
+            }
+#else    /* if (CUSTOMSS_NTF_COALESCE == 1) */
             uint8_t conidx = KE_IDX_GET(dest_id);
 
-            memset(&app_env_cs.to_air_buffer[0], val_notif, CS_VALUE_MAX_LENGTH);
-            if ((app_env_cs.to_air_cccd_value[0] == ATT_CCC_START_NTF &&
-                 app_env_cs.to_air_cccd_value[1] == 0x00)
-                && GAPC_IsConnectionActive(conidx))
+            if (GAPC_IsConnectionActive(conidx))
             {
-                /* Send notification to peer device */
-                GATTC_SendEvtCmd(conidx, GATTC_NOTIFY, 0, GATTM_GetHandle(CUST_SVC0, CS_TX_VALUE_VAL0),
-                                 CS_VALUE_MAX_LENGTH, app_env_cs.to_air_buffer);
-                val_notif++;
-                swmLogInfo("\n__CUSTOMSS notifying peer device %d\r\n", conidx);
+                CUSTOMSS_NotifyConnections(NTF_QUEUE_CON(conidx));
             }
 
-            if (app_env_cs.to_air_cccd_value_long[1] == 0x00 && GAPC_IsConnectionActive(conidx))
+            if (notifyOnTimeout)    /* Restart timer */
             {
-                /* Update RX long characteristic with the inverted version of
-                 * TX long characteristic */
-                for (uint8_t i = 0; i < CS_LONG_VALUE_MAX_LENGTH; i++)
-                {
-                    app_env_cs.from_air_buffer_long[i] = 0xFF ^ app_env_cs.to_air_buffer_long[i];
-                }
+                ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx),
+                             notifyOnTimeout);
+            }
+#endif    /* if (CUSTOMSS_NTF_COALESCE == 1) */
+        }
+        break;
 
-                if (app_env_cs.from_air_cccd_value_long[0] == ATT_CCC_START_IND)
-                {
-                    /* Send indication to peer device */
-                    GATTC_SendEvtCmd(conidx, GATTC_INDICATE, 0, GATTM_GetHandle(CUST_SVC0, CS_RX_LONG_VALUE_VAL0),
-                                     CS_LONG_VALUE_MAX_LENGTH, app_env_cs.from_air_buffer_long);
-                }
+        case GATTC_CMP_EVT:
+        {
+            const struct gattc_cmp_evt *p = param;
 
-                if (app_env_cs.from_air_cccd_value_long[0] == ATT_CCC_START_NTF)
-                {
-                    /* Send notification to peer device */
-                    GATTC_SendEvtCmd(conidx, GATTC_NOTIFY, 0, GATTM_GetHandle(CUST_SVC0, CS_RX_LONG_VALUE_VAL0),
-                                     CS_LONG_VALUE_MAX_LENGTH, app_env_cs.from_air_buffer_long);
-                }
+            if ((p->operation == GATTC_NOTIFY) && (p->seq_num == CS_STREAM_SEQ_NUM) &&
+                (KE_IDX_GET(src_id) < APP_MAX_NB_CON))
+            {
+                CUSTOMSS_StreamComplete(KE_IDX_GET(src_id), p->status);
+            }
+            else if ((p->operation == GATTC_INDICATE) && (p->seq_num == CS_IND_SEQ_NUM) &&
+                     (KE_IDX_GET(src_id) < APP_MAX_NB_CON))
+            {
+                CUSTOMSS_IndicateComplete(KE_IDX_GET(src_id), p->status);
             }
+        }
+        break;
 
-            if (notifyOnTimeout)    /* Restart timer */
+        case GATTC_MTU_CHANGED_IND:
+        {
+            const struct gattc_mtu_changed_ind *p = param;
+
+            if (KE_IDX_GET(src_id) < APP_MAX_NB_CON)
             {
-                ke_timer_set(CUSTOMSS_NTF_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx),
-                             notifyOnTimeout);
+                stream_env[KE_IDX_GET(src_id)].mtu = p->mtu;
+            }
+        }
+        break;
+
+        case GAPC_LE_PKT_SIZE_IND:
+        {
+            const struct gapc_le_pkt_size_ind *p = param;
+
+            if (KE_IDX_GET(src_id) < APP_MAX_NB_CON)
+            {
+                stream_env[KE_IDX_GET(src_id)].tx_octets = p->max_tx_octets;
+            }
+        }
+        break;
+
+        case GAPC_DISCONNECT_IND:
+        {
+            uint8_t conidx = KE_IDX_GET(src_id);
+            struct cs_stream_env *env;
+
+            if (conidx >= APP_MAX_NB_CON)
+            {
+                break;
             }
+
+            CUSTOMSS_LinkReset(conidx);
+
+            env = &stream_env[conidx];
+
+            /* Pending notifications are dropped with the link */
+            stream_credits += env->in_flight;
+            env->in_flight = 0;
+            env->enabled = false;
+            env->mtu = CS_STREAM_DEFAULT_MTU;
+            env->tx_octets = CS_STREAM_DEFAULT_TX_OCTETS;
         }
         break;
     }
@@ -242,10 +1032,9 @@ void CUSTOMSS_MsgHandler(ke_msg_id_t const msg_id, void const *param,
  * Function      : static void print_large_buffer(const uint8_t *buffer,
  *                                          uint16_t length)
  * ----------------------------------------------------------------------------
- * Description   : Use swmLogInfo for 10 Bytes of data at time.
- *                 remaining byte/s will be printed in string format to avoid
- *                 use of swmLogInfo for individual byte
- *                 This will result in reduce overhead for UART
+ * Description   : Record the data in the deferred trace log. The bytes are
+ *                 copied as is and printed in hex by tools/log_decoder.py,
+ *                 nothing is formatted on the device.
  * Inputs        : - buffer     - data buffer
  *                 - length     - length of data
  * Outputs       : None
@@ -253,38 +1042,87 @@ void CUSTOMSS_MsgHandler(ke_msg_id_t const msg_id, void const *param,
  * ------------------------------------------------------------------------- */
 static void print_large_buffer(const uint8_t *buffer, uint16_t length)
 {
-    unsigned int num_of_blocks = (length / 10);
-    unsigned int rem_bytes = ((num_of_blocks) ? (length % 10) : length);
+    TRACE_LOG_HEX("%s\r\n", buffer, length);
+}
 
-    for (int i = 0; i < num_of_blocks; i++)
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t CUSTOMSS_TXCharCallback(uint8_t conidx,
+ *                         uint16_t attidx, uint16_t handle, uint8_t *to,
+ *                         uint8_t *from, uint16_t length,
+ *                         uint16_t operation)
+ * ----------------------------------------------------------------------------
+ * Description   : User callback data access function for the TX
+ *                 characteristic. Notifications are built in pool messages,
+ *                 a read returns the last notified value.
+ * Inputs        : - conidx    - connection index
+ *                 - attidx    - attribute index in the user defined database
+ *                 - handle    - attribute handle allocated in the BLE stack
+ *                 - to        - pointer to destination buffer
+ *                 - from      - pointer to source buffer
+ *                 - length    - length of data to be copied
+ *                 - operation - GATTC_ReadReqInd
+ * Outputs       : ATT_ERR_NO_ERROR
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t CUSTOMSS_TXCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                uint8_t *to, const uint8_t *from,
+                                uint16_t length, uint16_t operation, uint8_t hl_status)
+{
+    if (hl_status != GAP_ERR_NO_ERROR)
     {
-        int j = (i * 10);
-        swmLogInfo("%02x %02x %02x %02x %02x %02x %02x %02x %02x %02x ", buffer[j],
-                   buffer[j + 1], buffer[j + 2], buffer[j + 3],
-                   buffer[j + 4], buffer[j + 5], buffer[j + 6],
-                   buffer[j + 7], buffer[j + 8], buffer[j + 9]);
+        return hl_status;
     }
 
-    if (rem_bytes)
+    /* Last notified value */
+    memset(to, (uint8_t)(val_notif - 1), length);
+
+    return ATT_ERR_NO_ERROR;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t CUSTOMSS_TXLongCharCallback(uint8_t conidx,
+ *                          uint16_t attidx, uint16_t handle, uint8_t *to,
+ *                          uint8_t *from, uint16_t length, uint16_t operation)
+ * ----------------------------------------------------------------------------
+ * Description   : User callback data access function for the TX Long
+ *                 characteristic. A read returns the complement of the RX
+ *                 long value of the peer, computed when read instead of on
+ *                 every write.
+ * Inputs        : - conidx    - connection index
+ *                 - attidx    - attribute index in the user defined database
+ *                 - handle    - attribute handle allocated in the BLE stack
+ *                 - to        - pointer to destination buffer
+ *                 - from      - pointer to source buffer
+ *                 - length    - length of data to be copied
+ *                 - operation - GATTC_ReadReqInd
+ * Outputs       : ATT_ERR_NO_ERROR
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t CUSTOMSS_TXLongCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                    uint8_t *to, const uint8_t *from,
+                                    uint16_t length, uint16_t operation, uint8_t hl_status)
+{
+    if (hl_status != GAP_ERR_NO_ERROR)
     {
-        int j = (num_of_blocks * 10);
-        char temp_string[28] = { 0 };
-        uint8_t index = 0;
+        return hl_status;
+    }
 
-        for (int i = j; i < length; i++)
-        {
-            sprintf(&temp_string[index], "%02x", buffer[i]);
-            index += 2;
+    if (conidx >= APP_MAX_NB_CON)
+    {
+        return ATT_ERR_APP_ERROR;
+    }
 
-            /* put space before next data */
-            temp_string[index] = 0x20;
-            index += 1;
-        }
+    if (length > CS_LONG_VALUE_MAX_LENGTH)
+    {
+        length = CS_LONG_VALUE_MAX_LENGTH;
+    }
 
-        swmLogInfo("%s ", temp_string);
+    for (uint16_t i = 0; i < length; i++)
+    {
+        to[i] = 0xFF ^ cs_link[conidx].from_air_buffer_long[i];
     }
 
-    swmLogInfo("\r\n");
+    return ATT_ERR_NO_ERROR;
 }
 
 /* ----------------------------------------------------------------------------
@@ -316,16 +1154,36 @@ uint8_t CUSTOMSS_RXCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle
                                 uint8_t *to, const uint8_t *from,
                                 uint16_t length, uint16_t operation, uint8_t hl_status)
 {
-    if (hl_status == GAP_ERR_NO_ERROR)
+    if ((hl_status == GAP_ERR_NO_ERROR) && (conidx < APP_MAX_NB_CON))
     {
-        memcpy(to, from, length);
-        swmLogInfo("\nRXCharCallback (%d):(%d) ", conidx, length);
-        print_large_buffer(app_env_cs.from_air_buffer, length);
+        struct cs_link_env *link = &cs_link[conidx];
+
+        if (operation == GATTC_WRITE_REQ_IND)
+        {
+            /* Keep the value of each peer */
+            if (length > CS_VALUE_MAX_LENGTH)
+            {
+                length = CS_VALUE_MAX_LENGTH;
+            }
+            memcpy(link->from_air_buffer, from, length);
+            link->from_air_length = (uint8_t)length;
+            APP_LOG_INFO("\nRXCharCallback (%d):(%d) ", conidx, length);
+            print_large_buffer(link->from_air_buffer, length);
+        }
+        else
+        {
+            /* Return the value last written by this peer, the rest of the
+             * attribute reads as zero */
+            uint16_t valid = (link->from_air_length < length) ? link->from_air_length : length;
+
+            memcpy(to, link->from_air_buffer, valid);
+            memset(&to[valid], 0, length - valid);
+        }
         return ATT_ERR_NO_ERROR;
     }
     else
     {
-        swmLogInfo("\nRXCharCallback (%d): operation (%d): error(%d)\r\n", conidx, operation, hl_status);
+        APP_LOG_INFO("\nRXCharCallback (%d): operation (%d): error(%d)\r\n", conidx, operation, hl_status);
         return hl_status;
     }
 }
@@ -340,10 +1198,9 @@ uint8_t CUSTOMSS_RXCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle
  *                 abstraction whenever a ReadReqInd or WriteReqInd occurs in
  *                 the specified attribute. The callback is linked to the
  *                 attribute in the database construction. See att_db.
- *                 When a write occurs in the RX long characteristic, besides
- *                 updating the database value, this function updates the TX
- *                 Long characteristic value with the complement if the written
- *                 value.
+ *                 A write is indicated to the subscribed peers, the TX Long
+ *                 characteristic reads as its complement (see
+ *                 CUSTOMSS_TXLongCharCallback).
  * Inputs        : - conidx    - connection index
  *                 - attidx    - attribute index in the user defined database
  *                 - handle    - attribute handle allocated in the BLE stack
@@ -362,26 +1219,185 @@ uint8_t CUSTOMSS_RXLongCharCallback(uint8_t conidx, uint16_t attidx, uint16_t ha
                                     uint8_t *to, const uint8_t *from,
                                     uint16_t length, uint16_t operation, uint8_t hl_status)
 {
-    if (hl_status == GAP_ERR_NO_ERROR)
+    if ((hl_status == GAP_ERR_NO_ERROR) && (conidx < APP_MAX_NB_CON))
     {
-        memcpy(to, from, length);
-        swmLogInfo("\nRXLongCharCallback (%d):(%d) ", conidx, length);
-        print_large_buffer(app_env_cs.from_air_buffer_long, length);
+        struct cs_link_env *link = &cs_link[conidx];
+
+        if (length > CS_LONG_VALUE_MAX_LENGTH)
+        {
+            length = CS_LONG_VALUE_MAX_LENGTH;
+        }
 
-        /* Update TX long characteristic with the inverted version of
-         * RX long characteristic just received */
         if (operation == GATTC_WRITE_REQ_IND)
         {
-            for (uint8_t i = 0; i < CS_LONG_VALUE_MAX_LENGTH; i++)
-            {
-                app_env_cs.to_air_buffer_long[i] = 0xFF ^ app_env_cs.from_air_buffer_long[i];
-            }
+            /* Keep the value of each peer */
+            memcpy(link->from_air_buffer_long, from, length);
+            APP_LOG_INFO("\nRXLongCharCallback (%d):(%d) ", conidx, length);
+            print_large_buffer(link->from_air_buffer_long, length);
+
+            /* Indicate the new value now rather than at the next timer tick */
+            CUSTOMSS_IndicateLong(CUSTOMSS_Subscribers(CS_CCC_RX_LONG, ATT_CCC_START_IND) &
+                                  NTF_QUEUE_CON(conidx));
+        }
+        else
+        {
+            memcpy(to, link->from_air_buffer_long, length);
         }
         return ATT_ERR_NO_ERROR;
     }
     else
     {
-        swmLogInfo("\nRXLongCharCallback (%d): operation (%d): error(%d) \r\n", conidx, operation, hl_status);
+        APP_LOG_INFO("\nRXLongCharCallback (%d): operation (%d): error(%d) \r\n", conidx, operation, hl_status);
+        return hl_status;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t CUSTOMSS_DiagCharCallback(uint8_t conidx,
+ *                          uint16_t attidx, uint16_t handle, uint8_t *to,
+ *                          uint8_t *from, uint16_t length, uint16_t operation)
+ * ----------------------------------------------------------------------------
+ * Description   : User callback data access function for the diagnostics
+ *                 characteristic. A write selects the wakeup profiler phase
+ *                 (first byte), a read returns the histogram of the selected
+ *                 phase, see Profiler_Get_Histogram().
+ * Inputs        : - conidx    - connection index
+ *                 - attidx    - attribute index in the user defined database
+ *                 - handle    - attribute handle allocated in the BLE stack
+ *                 - to        - pointer to destination buffer
+ *                 - from      - pointer to source buffer
+ *                 - length    - length of data to be copied
+ *                 - operation - GATTC_ReadReqInd or GATTC_WriteReqInd
+ * Outputs       : ATT_ERR_NO_ERROR
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t CUSTOMSS_DiagCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                  uint8_t *to, const uint8_t *from,
+                                  uint16_t length, uint16_t operation, uint8_t hl_status)
+{
+    if (hl_status != GAP_ERR_NO_ERROR)
+    {
+        return hl_status;
+    }
+
+    if (operation == GATTC_WRITE_REQ_IND)
+    {
+        if ((length < 1) || (from[0] >= PROFILER_PHASE_NB))
+        {
+            return ATT_ERR_APP_ERROR;
+        }
+
+        app_env_cs.diag_phase = from[0];
+    }
+    else
+    {
+        /* Refresh the value just before it is read */
+        Profiler_Get_Histogram(app_env_cs.diag_phase, app_env_cs.diag_buffer,
+                               sizeof(app_env_cs.diag_buffer));
+        memcpy(to, from, length);
+    }
+
+    return ATT_ERR_NO_ERROR;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t CUSTOMSS_StreamCCCCallback(uint8_t conidx,
+ *                          uint16_t attidx, uint16_t handle, uint8_t *to,
+ *                          uint8_t *from, uint16_t length, uint16_t operation)
+ * ----------------------------------------------------------------------------
+ * Description   : User callback data access function for the stream client
+ *                 characteristic configuration. Enabling notifications
+ *                 starts the stream, disabling them stops it.
+ * Inputs        : - conidx    - connection index
+ *                 - attidx    - attribute index in the user defined database
+ *                 - handle    - attribute handle allocated in the BLE stack
+ *                 - to        - pointer to destination buffer
+ *                 - from      - pointer to source buffer
+ *                 - length    - length of data to be copied
+ *                 - operation - GATTC_ReadReqInd or GATTC_WriteReqInd
+ * Outputs       : ATT_ERR_NO_ERROR, or the error returned by
+ *                 CUSTOMSS_CCCCallback()
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t CUSTOMSS_StreamCCCCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                   uint8_t *to, const uint8_t *from,
+                                   uint16_t length, uint16_t operation, uint8_t hl_status)
+{
+    uint8_t status = CUSTOMSS_CCCCallback(conidx, attidx, handle, to, from, length,
+                                          operation, hl_status);
+
+    if (status != ATT_ERR_NO_ERROR)
+    {
+        return status;
+    }
+
+    if (operation == GATTC_WRITE_REQ_IND)
+    {
+        if ((length >= 1) && (from[0] & ATT_CCC_START_NTF))
+        {
+            CUSTOMSS_StreamStart(conidx);
+        }
+        else
+        {
+            CUSTOMSS_StreamStop(conidx);
+        }
+    }
+
+    return ATT_ERR_NO_ERROR;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t CUSTOMSS_CCCCallback(uint8_t conidx,
+ *                          uint16_t attidx, uint16_t handle, uint8_t *to,
+ *                          uint8_t *from, uint16_t length, uint16_t operation)
+ * ----------------------------------------------------------------------------
+ * Description   : User callback data access function for the client
+ *                 characteristic configuration descriptors. The value is
+ *                 stored and returned per link, see cs_link.
+ * Inputs        : - conidx    - connection index
+ *                 - attidx    - attribute index in the user defined database
+ *                 - handle    - attribute handle allocated in the BLE stack
+ *                 - to        - pointer to destination buffer
+ *                 - from      - pointer to source buffer
+ *                 - length    - length of data to be copied
+ *                 - operation - GATTC_ReadReqInd or GATTC_WriteReqInd
+ * Outputs       : ATT_ERR_NO_ERROR
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t CUSTOMSS_CCCCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                             uint8_t *to, const uint8_t *from,
+                             uint16_t length, uint16_t operation, uint8_t hl_status)
+{
+    uint8_t ccc = CUSTOMSS_CCCIndex(attidx);
+
+    if (hl_status != GAP_ERR_NO_ERROR)
+    {
         return hl_status;
     }
+
+    if ((ccc == CS_CCC_NB) || (conidx >= APP_MAX_NB_CON))
+    {
+        return ATT_ERR_APP_ERROR;
+    }
+
+    if (operation == GATTC_WRITE_REQ_IND)
+    {
+        cs_link[conidx].ccc[ccc] = (length >= 1) ? from[0] : 0;
+
+        /* A value waiting for the in flight indication is not sent once
+         * the peer unsubscribes */
+        if ((ccc == CS_CCC_RX_LONG) && !(cs_link[conidx].ccc[ccc] & ATT_CCC_START_IND) &&
+            cs_link[conidx].ind_pending)
+        {
+            cs_link[conidx].ind_pending = false;
+            cs_link[conidx].ind_stats.dropped++;
+        }
+    }
+    else if (length >= 2)
+    {
+        to[0] = cs_link[conidx].ccc[ccc];
+        to[1] = 0x00;
+    }
+
+    return ATT_ERR_NO_ERROR;
 }
@@ -0,0 +1,231 @@
+/**
+ * @file app_dispatch.c
+ * @brief Application message dispatch source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  DIAG
+
+#include "app.h"
+#include <string.h>
+
+#define APP_DISPATCH_NONE               0xFF
+
+/**
+ * @brief Second level entry, one handler. Handlers of the same message ID
+ *        and operation are chained in registration order.
+ */
+typedef struct
+{
+    app_dispatch_handler_t handler;
+    uint8_t next;                           /**< Next handler of the same ID and operation */
+} app_dispatch_handler_entry_t;
+
+/**
+ * @brief First level entry, one message ID
+ */
+typedef struct
+{
+    ke_msg_id_t msg_id;
+    uint8_t used;
+    uint8_t any_op;                         /**< First handler of every instance, APP_DISPATCH_NONE if none */
+    uint8_t op_table;                       /**< Operation table, APP_DISPATCH_NONE if the ID has none */
+    app_dispatch_stats_t stats;
+} app_dispatch_msg_entry_t;
+
+static app_dispatch_msg_entry_t app_dispatch_msg[APP_DISPATCH_MSG_NB];
+static app_dispatch_handler_entry_t app_dispatch_handler[APP_DISPATCH_HANDLER_NB];
+
+/* Second level tables, first handler of each operation */
+static uint8_t app_dispatch_op[APP_DISPATCH_OP_TABLE_NB][APP_DISPATCH_OP_NB];
+
+static uint8_t app_dispatch_handler_nb = 0;
+static uint8_t app_dispatch_op_table_nb = 0;
+
+static void AppDispatch_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                                   ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Hash of a message ID: message index in its task and task type
+ */
+static uint32_t AppDispatch_Hash(ke_msg_id_t msg_id)
+{
+    return ((msg_id & 0xFF) ^ (msg_id >> 8) * 7) & (APP_DISPATCH_MSG_NB - 1);
+}
+
+/**
+ * @brief Find the entry of a message ID
+ *
+ * @param[in] create Allocate the entry if the ID is not registered
+ */
+static app_dispatch_msg_entry_t * AppDispatch_Find(ke_msg_id_t msg_id, bool create)
+{
+    uint32_t idx = AppDispatch_Hash(msg_id);
+
+    /* Linear probing */
+    for (uint32_t i = 0; i < APP_DISPATCH_MSG_NB; i++)
+    {
+        app_dispatch_msg_entry_t *e = &app_dispatch_msg[(idx + i) & (APP_DISPATCH_MSG_NB - 1)];
+
+        if (!e->used)
+        {
+            if (!create)
+            {
+                return NULL;
+            }
+
+            e->msg_id = msg_id;
+            e->used = 1;
+            e->any_op = APP_DISPATCH_NONE;
+            e->op_table = APP_DISPATCH_NONE;
+
+            /* One subscription to the abstraction per message ID */
+            MsgHandler_Add(msg_id, AppDispatch_MsgHandler);
+            return e;
+        }
+
+        if (e->msg_id == msg_id)
+        {
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Append a handler at the end of a chain
+ */
+static void AppDispatch_Chain(uint8_t *first, uint8_t handler)
+{
+    while (*first != APP_DISPATCH_NONE)
+    {
+        first = &app_dispatch_handler[*first].next;
+    }
+
+    *first = handler;
+}
+
+void AppDispatch_Add_Op(ke_msg_id_t msg_id, uint16_t operation, app_dispatch_handler_t handler)
+{
+    app_dispatch_msg_entry_t *e = AppDispatch_Find(msg_id, true);
+
+    if ((e == NULL) || (app_dispatch_handler_nb >= APP_DISPATCH_HANDLER_NB) ||
+        ((operation != APP_DISPATCH_ANY_OP) && (operation >= APP_DISPATCH_OP_NB)))
+    {
+        APP_LOG_ERROR("AppDispatch: no room for msg 0x%04x\r\n", msg_id);
+        return;
+    }
+
+    if ((operation != APP_DISPATCH_ANY_OP) && (e->op_table == APP_DISPATCH_NONE))
+    {
+        if (app_dispatch_op_table_nb >= APP_DISPATCH_OP_TABLE_NB)
+        {
+            APP_LOG_ERROR("AppDispatch: no operation table for msg 0x%04x\r\n", msg_id);
+            return;
+        }
+
+        e->op_table = app_dispatch_op_table_nb++;
+        memset(app_dispatch_op[e->op_table], APP_DISPATCH_NONE, APP_DISPATCH_OP_NB);
+    }
+
+    app_dispatch_handler[app_dispatch_handler_nb].handler = handler;
+    app_dispatch_handler[app_dispatch_handler_nb].next = APP_DISPATCH_NONE;
+
+    /* Keep registration order */
+    if (operation == APP_DISPATCH_ANY_OP)
+    {
+        AppDispatch_Chain(&e->any_op, app_dispatch_handler_nb);
+    }
+    else
+    {
+        AppDispatch_Chain(&app_dispatch_op[e->op_table][operation], app_dispatch_handler_nb);
+    }
+
+    app_dispatch_handler_nb++;
+}
+
+void AppDispatch_Add(ke_msg_id_t msg_id, app_dispatch_handler_t handler)
+{
+    AppDispatch_Add_Op(msg_id, APP_DISPATCH_ANY_OP, handler);
+}
+
+/**
+ * @brief Single handler subscribed to the abstraction for every registered
+ *        message ID
+ */
+static void AppDispatch_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                                   ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    app_dispatch_msg_entry_t *e = AppDispatch_Find(msg_id, false);
+    uint8_t first_op = APP_DISPATCH_NONE;
+    uint32_t start;
+    uint32_t cycles;
+
+    if (e == NULL)
+    {
+        return;
+    }
+
+    /* All completion events start with the operation, its handlers are
+     * found by index */
+    if (e->op_table != APP_DISPATCH_NONE)
+    {
+        first_op = app_dispatch_op[e->op_table][*(const uint8_t *)param];
+    }
+
+    if ((e->any_op == APP_DISPATCH_NONE) && (first_op == APP_DISPATCH_NONE))
+    {
+        e->stats.count++;
+        e->stats.unhandled++;
+        return;
+    }
+
+    /* Only sleep restarts the counter, never between these reads */
+    start = Profiler_Get_Cycles();
+
+    for (uint8_t i = e->any_op; i != APP_DISPATCH_NONE; i = app_dispatch_handler[i].next)
+    {
+        app_dispatch_handler[i].handler(msg_id, param, dest_id, src_id);
+    }
+
+    for (uint8_t i = first_op; i != APP_DISPATCH_NONE; i = app_dispatch_handler[i].next)
+    {
+        app_dispatch_handler[i].handler(msg_id, param, dest_id, src_id);
+    }
+
+    cycles = Profiler_Get_Cycles() - start;
+
+    e->stats.count++;
+    e->stats.cycles += cycles;
+    if (cycles > e->stats.max_cycles)
+    {
+        e->stats.max_cycles = cycles;
+    }
+}
+
+void AppDispatch_Log(void)
+{
+    for (uint32_t i = 0; i < APP_DISPATCH_MSG_NB; i++)
+    {
+        const app_dispatch_msg_entry_t *e = &app_dispatch_msg[i];
+
+        if (e->used && e->stats.count)
+        {
+            TRACE_LOG("STAT dispatch 0x%04x n=%lu unhandled=%lu cycles=%lu max=%lu\r\n",
+                      e->msg_id, e->stats.count, e->stats.unhandled,
+                      e->stats.cycles, e->stats.max_cycles);
+        }
+    }
+}
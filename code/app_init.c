@@ -20,14 +20,6 @@
 #define XTAL32K_CTRIM_21P6PF    ((uint32_t)(0x36U << ACS_XTAL32K_CTRL_CLOAD_TRIM_Pos))
 #define XTAL32K_CTRIM_23P2PF    ((uint32_t)(0x3AU << ACS_XTAL32K_CTRL_CLOAD_TRIM_Pos))
 
-static uint32_t traceOptions[] = {
-    SWM_LOG_LEVEL_INFO,                 /* In all cases log info messages */
-    SWM_UART_RX_PIN | UART_RX_GPIO,     /* Set RX pin for cases when using UART */
-    SWM_UART_TX_PIN | UART_TX_GPIO,     /* Set TX pin for cases when using UART */
-    SWM_UART_RX_ENABLE,                 /* Enable the UART Rx Interrupts */
-    SWM_UART_BAUD_RATE | UART_BAUD      /* Set Baud rate */
-};
-
 extern sleep_mode_cfg app_sleep_mode_cfg;
 
 struct timeCode
@@ -141,39 +133,25 @@ void DeviceInit(void)
     }
 #endif    /* ifdef VOLTAGES_CALIB_VERIFY */
 
-    /* Disable Sensor and CryptoCell power to achieve lowest power in Deep Sleep mode*/
-#if SENSOR_POWER_DISABLE
-    Sys_Sensor_Disable();
-#endif    /* if SENSOR_POWER_DISABLE */
-
-#if CC312AO_POWER_DISABLE
-    Sys_Power_CC312AO_Disable();
-#endif    /* if CC312AO_POWER_DISABLE */
-
-#if POWER_DOWN_FPU
+    /* Power down Sensor, CryptoCell, FPU, DBG and VDDIF as selected in app.h
+     * to achieve lowest power in Deep Sleep mode. These domains are powered
+     * up again while a user holds them, see PowerRes_Acquire(). */
+    PowerRes_Init();
 
-    /* Power Down FPU */
-    Power_Down_FPU();
-#endif    /* if POWER_DOWN_FPU */
+    /* Measure the battery for the advertising policy */
+    APP_BASS_Init();
 
-#if POWER_DOWN_DBG
-
-    /* Power Down DBG */
-    Power_Down_Debug();
-#endif    /* if POWER_DOWN_DBG */
+    /* Configure the wakeup source */
+    Wakeup_Source_Config();
 
-#if VDDIF_POWER_DOWN
+    /* Keep wakeup histograms from before a warm reset if they are valid */
+    Profiler_Init();
 
-    /* Disable VDDIF */
-    ACS->VDDIF_CTRL &= ~VDDIF_ENABLE;
-#else    /* if VDDIF_POWER_DOWN */
+    /* Keep power state transitions from before a warm reset */
+    PowerRec_Init();
 
-    /* Enable VDDIF */
-    ACS->VDDIF_CTRL |= VDDIF_ENABLE;
-#endif    /* if VDDIF_POWER_DOWN */
-
-    /* Configure the wakeup source */
-    Wakeup_Source_Config();
+    /* Keep sleep statistics from before a sleep without retention */
+    SleepPolicy_Init();
 
     /* Sleep Initialization for Power Mode */
     App_Sleep_Initialization();
@@ -188,35 +166,113 @@ void DeviceInit(void)
     RESET->DIG_STATUS = (uint32_t)0x1F00;
     ACS->RESET_STATUS = (uint32_t)0x3FF;
 
-    /* Initialize trace library */
-    swmTrace_init(traceOptions, 5);
+    /* Trace library is initialized on first log, see Trace_Acquire() */
 }
 
 void AppMsgHandlersInit(void)
 {
+    /* Each message ID is subscribed once to the BLE abstraction, completion
+     * events are then delivered only to the handler of their operation.
+     * See app_dispatch.h */
+
     /* BLE Database setup handler */
-    MsgHandler_Add(GAPM_CMP_EVT, BLE_ConfigHandler);
-    MsgHandler_Add(GAPM_PROFILE_ADDED_IND, BLE_ConfigHandler);
-    MsgHandler_Add(GATTM_ADD_SVC_RSP, BLE_ConfigHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_RESET, BLE_ConfigHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_SET_DEV_CONFIG, BLE_ConfigHandler);
+    AppDispatch_Add(GAPM_PROFILE_ADDED_IND, BLE_ConfigHandler);
+    AppDispatch_Add(GATTM_ADD_SVC_RSP, BLE_ConfigHandler);
+
+#if (APP_BROADCAST_ENABLE == 1)
+    /* Broadcast handler, registered before the activity handler so the
+     * broadcast set is known when its creation is indicated */
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_CREATE_ADV_ACTIVITY, Broadcast_MsgHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_SET_ADV_DATA, Broadcast_MsgHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_SET_PERIOD_ADV_DATA, Broadcast_MsgHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_START_ACTIVITY, Broadcast_MsgHandler);
+    AppDispatch_Add(GAPM_ACTIVITY_CREATED_IND, Broadcast_MsgHandler);
+    AppDispatch_Add(GAPM_ACTIVITY_STOPPED_IND, Broadcast_MsgHandler);
+#endif    /* if (APP_BROADCAST_ENABLE == 1) */
 
     /* BLE Activity handler (responsible for air operations) */
-    MsgHandler_Add(GAPM_CMP_EVT, BLE_ActivityHandler);
-    MsgHandler_Add(GAPM_ACTIVITY_CREATED_IND, BLE_ActivityHandler);
-    MsgHandler_Add(GAPM_ACTIVITY_STOPPED_IND, BLE_ActivityHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_SET_ADV_DATA, BLE_ActivityHandler);
+    AppDispatch_Add(GAPM_ACTIVITY_CREATED_IND, BLE_ActivityHandler);
+    AppDispatch_Add(GAPM_ACTIVITY_STOPPED_IND, BLE_ActivityHandler);
 
     /* Connection handler */
-    MsgHandler_Add(GAPM_CMP_EVT, BLE_ConnectionHandler);
-    MsgHandler_Add(GAPC_CONNECTION_REQ_IND, BLE_ConnectionHandler);
-    MsgHandler_Add(GAPC_DISCONNECT_IND, BLE_ConnectionHandler);
-    MsgHandler_Add(GAPM_ADDR_SOLVED_IND, BLE_ConnectionHandler);
-    MsgHandler_Add(GAPC_GET_DEV_INFO_REQ_IND, BLE_ConnectionHandler);
-    MsgHandler_Add(GAPC_PARAM_UPDATE_REQ_IND, BLE_ConnectionHandler);
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_RESOLV_ADDR, BLE_ConnectionHandler);
+    AppDispatch_Add(GAPC_CONNECTION_REQ_IND, BLE_ConnectionHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, BLE_ConnectionHandler);
+    AppDispatch_Add(GAPM_ADDR_SOLVED_IND, BLE_ConnectionHandler);
+    AppDispatch_Add(GAPC_GET_DEV_INFO_REQ_IND, BLE_ConnectionHandler);
+    AppDispatch_Add(GAPC_PARAM_UPDATE_REQ_IND, BLE_ConnectionHandler);
 
     /* Pairing / bonding  handler */
-    MsgHandler_Add(GAPC_BOND_REQ_IND, BLE_PairingHandler);
-    MsgHandler_Add(GAPC_BOND_IND, BLE_PairingHandler);
-    MsgHandler_Add(GAPC_ENCRYPT_REQ_IND, BLE_PairingHandler);
-    MsgHandler_Add(GAPC_ENCRYPT_IND, BLE_PairingHandler);
+    AppDispatch_Add(GAPC_BOND_REQ_IND, BLE_PairingHandler);
+    AppDispatch_Add(GAPC_BOND_IND, BLE_PairingHandler);
+    AppDispatch_Add(GAPC_ENCRYPT_REQ_IND, BLE_PairingHandler);
+    AppDispatch_Add(GAPC_ENCRYPT_IND, BLE_PairingHandler);
+
+    /* Connection parameter policy handler */
+    AppDispatch_Add(GAPC_CONNECTION_REQ_IND, ConnPolicy_MsgHandler);
+    AppDispatch_Add(GAPC_PARAM_UPDATED_IND, ConnPolicy_MsgHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, ConnPolicy_MsgHandler);
+    AppDispatch_Add(CONN_POLICY_IDLE_TIMEOUT, ConnPolicy_MsgHandler);
+
+    /* PHY manager handler */
+    AppDispatch_Add(GAPC_CONNECTION_REQ_IND, PhyMgr_MsgHandler);
+    AppDispatch_Add(GAPC_LE_PHY_IND, PhyMgr_MsgHandler);
+    AppDispatch_Add(GAPC_CON_RSSI_IND, PhyMgr_MsgHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, PhyMgr_MsgHandler);
+    AppDispatch_Add(PHY_MGR_RSSI_TIMEOUT, PhyMgr_MsgHandler);
+
+#if (APP_L2CAP_OFFLOAD_ENABLE == 1)
+    /* L2CAP offload handler */
+    AppDispatch_Add(GAPC_LECB_CONNECT_REQ_IND, L2capOffload_MsgHandler);
+    AppDispatch_Add(GAPC_LECB_CONNECT_IND, L2capOffload_MsgHandler);
+    AppDispatch_Add(GAPC_LECB_ADD_IND, L2capOffload_MsgHandler);
+    AppDispatch_Add(GAPC_LECB_DISCONNECT_IND, L2capOffload_MsgHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, L2capOffload_MsgHandler);
+    AppDispatch_Add(L2CC_LECB_SDU_RECV_IND, L2capOffload_MsgHandler);
+    AppDispatch_Add_Op(L2CC_CMP_EVT, L2CC_LECB_SDU_SEND, L2capOffload_MsgHandler);
+#endif    /* if (APP_L2CAP_OFFLOAD_ENABLE == 1) */
+
+    /* Bond cache handler (learns resolved addresses, writes pending bonds) */
+    AppDispatch_Add(GAPM_ADDR_SOLVED_IND, BondCache_MsgHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, BondCache_MsgHandler);
+
+    /* Advertising policy handler (re-creates the activity on interval change) */
+    AppDispatch_Add_Op(GAPM_CMP_EVT, GAPM_DELETE_ACTIVITY, AdvPolicy_MsgHandler);
+}
+
+void AppStatsReportInit(void)
+{
+    /* Each module logs its own counters, one module per wakeup of a report.
+     * See stats_report.h */
+    StatsReport_Add(PowerRes_Log_Stats);
+    StatsReport_Add(SleepCoord_Log_Stats);
+    StatsReport_Add(SleepPolicy_Log_Stats);
+    StatsReport_Add(Clock_Log_Stats);
+    StatsReport_Add(TraceLog_Log_Stats);
+    StatsReport_Add(AppDispatch_Log);
+
+    /* Advertising */
+    StatsReport_Add(AdvPolicy_Log_Stats);
+    StatsReport_Add(AdvData_Log_Stats);
+#if (APP_BROADCAST_ENABLE == 1)
+    StatsReport_Add(Broadcast_Log_Stats);
+#endif    /* if (APP_BROADCAST_ENABLE == 1) */
+
+    /* Connections */
+    StatsReport_Add(BondCache_Log_Stats);
+    StatsReport_Add(ConnPolicy_Log_Stats);
+    StatsReport_Add(PhyMgr_Log_Stats);
+#if (APP_L2CAP_OFFLOAD_ENABLE == 1)
+    StatsReport_Add(L2capOffload_Log_Stats);
+#endif    /* if (APP_L2CAP_OFFLOAD_ENABLE == 1) */
+
+    /* Custom service */
+    StatsReport_Add(NtfQueue_Log_Stats);
+    StatsReport_Add(CUSTOMSS_StreamLogStats);
+    StatsReport_Add(CUSTOMSS_IndLogStats);
 }
 
 void CustomServiceServerInit(void)
@@ -276,6 +332,7 @@ void EnableAppInterrupts(void)
     NVIC_ClearPendingIRQ(BLE_FINETGT_IRQn);
     NVIC_ClearPendingIRQ(BLE_TIMESTAMP_TGT2_IRQn);
     NVIC_ClearPendingIRQ(BLE_SW_IRQn);
+    NVIC_ClearPendingIRQ(TRACE_LOG_DMA_IRQn);
 
     NVIC_EnableIRQ(BLE_HSLOT_IRQn);
     NVIC_EnableIRQ(BLE_SLP_IRQn);
@@ -286,6 +343,7 @@ void EnableAppInterrupts(void)
     NVIC_EnableIRQ(BLE_FINETGT_IRQn);
     NVIC_EnableIRQ(BLE_TIMESTAMP_TGT2_IRQn);
     NVIC_EnableIRQ(BLE_SW_IRQn);
+    NVIC_EnableIRQ(TRACE_LOG_DMA_IRQn);
 
     __set_FAULTMASK(FAULTMASK_ENABLE_INTERRUPTS);
     __set_PRIMASK(PRIMASK_ENABLE_INTERRUPTS);
@@ -457,6 +515,27 @@ uint32_t Power_Down_FPU(void)
     return success;
 }
 
+/**
+ * @brief Power Up the FPU after Power_Down_FPU()
+ */
+void Power_Up_FPU(void)
+{
+    /* Enable power switches, trickle first to limit inrush current */
+    SYSCTRL->FPU_PWR_CFG = FPU_WRITE_KEY | FPU_Q_REQUEST | FPU_ISOLATE |
+                           FPU_PWR_TRICKLE_ENABLE  | FPU_PWR_HAMMER_DISABLE;
+    SYSCTRL->FPU_PWR_CFG = FPU_WRITE_KEY | FPU_Q_REQUEST | FPU_ISOLATE |
+                           FPU_PWR_TRICKLE_ENABLE  | FPU_PWR_HAMMER_ENABLE;
+
+    /* Remove isolation and release the power down request */
+    SYSCTRL->FPU_PWR_CFG = FPU_WRITE_KEY | FPU_Q_NOT_REQUEST |
+                           FPU_PWR_TRICKLE_ENABLE  | FPU_PWR_HAMMER_ENABLE;
+
+    /* Wait for the Q-channel handshake, the FPU is usable once it left the
+     * quiescent state */
+    while ((SYSCTRL->FPU_PWR_CFG & (0x1U << SYSCTRL_FPU_PWR_CFG_FPU_Q_ACCEPT_Pos)) ==
+           FPU_Q_ACCEPTED);
+}
+
 /**
  * @brief Power Down the DBG Unit
  * @return DBG_Q_ACCEPTED if the DBG power down was successful.<br>
@@ -497,6 +576,27 @@ uint32_t Power_Down_Debug(void)
     return success;
 }
 
+/**
+ * @brief Power Up the DBG Unit after Power_Down_Debug()
+ */
+void Power_Up_Debug(void)
+{
+    /* Enable power switches, trickle first to limit inrush current */
+    SYSCTRL->DBG_PWR_CFG = DBG_WRITE_KEY | DBG_Q_REQUEST | DBG_ISOLATE |
+                           DBG_PWR_TRICKLE_ENABLE  | DBG_PWR_HAMMER_DISABLE;
+    SYSCTRL->DBG_PWR_CFG = DBG_WRITE_KEY | DBG_Q_REQUEST | DBG_ISOLATE |
+                           DBG_PWR_TRICKLE_ENABLE  | DBG_PWR_HAMMER_ENABLE;
+
+    /* Remove isolation and release the power down request */
+    SYSCTRL->DBG_PWR_CFG = DBG_WRITE_KEY | DBG_Q_NOT_REQUEST |
+                           DBG_PWR_TRICKLE_ENABLE  | DBG_PWR_HAMMER_ENABLE;
+
+    /* Wait for the Q-channel handshake, the debug unit is usable once it
+     * left the quiescent state */
+    while ((SYSCTRL->DBG_PWR_CFG & (0x1U << SYSCTRL_DBG_PWR_CFG_DBG_Q_ACCEPT_Pos)) ==
+           DBG_Q_ACCEPTED);
+}
+
 /**
  * @brief Convert RTC cycles to time in number of
  *        Day/s Hour/s minutes/s second/s milisecond/s
@@ -517,18 +617,10 @@ static void Convert_To_Time(uint64_t total_rtc_cycles)
                         - (current_time.min * 60));
 
     /* Divide by number of RTC Cycles in millisecond and subtract day & hour & minute & second */
-    current_time.ms = ((total_RTC_cycles / 32.768) - (current_time.day * 86400000) - (current_time.hour * 3600000) \
+    current_time.ms = (((total_RTC_cycles * 1000) / 32768) - (current_time.day * 86400000) - (current_time.hour * 3600000) \
                        - (current_time.min * 60000) - (current_time.sec * 1000));
 }
 
-/**
- * @brief Initialize swmTrace after wakeup from sleep
- */
-void Init_SWMTrace(void)
-{
-    swmTrace_init(traceOptions, 5);
-}
-
 /**
  * @brief Print time information
  */
@@ -536,10 +628,10 @@ void Print_Time_Info(uint64_t total_rtc_cycles)
 {
     /* Convert RTC cycles to time */
     Convert_To_Time(total_rtc_cycles);
-    swmLogInfo("\n\rTotal RTC Cycles: %d\n\r", total_rtc_cycles);
-    swmLogInfo("\n\rDays: %d\n\rHours: %d\n\rMins: %d\n\rSecs: %d\n\rMillisecs: %d\n\r",
-               current_time.day, current_time.hour, current_time.min, current_time.sec, current_time.ms);
 
-    /* Delay for logs */
-    Sys_Delay(0.025 * SystemCoreClock);
+    /* Recorded in binary and sent before sleep, decode the capture with
+     * tools/log_decoder.py */
+    TRACE_LOG("\n\rTotal RTC Cycles: %llu\n\r", TRACE_LOG_U64(total_rtc_cycles));
+    TRACE_LOG("\n\rDays: %d\n\rHours: %d\n\rMins: %d\n\rSecs: %d\n\rMillisecs: %d\n\r",
+              current_time.day, current_time.hour, current_time.min, current_time.sec, current_time.ms);
 }
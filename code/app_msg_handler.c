@@ -15,6 +15,8 @@
  * @endparblock
  */
 
+#define APP_LOG_MODULE                  BLE
+
 #include <app.h>
 
 uint8_t app_adv_data[ADV_DATA_LEN], app_scan_rsp_data[ADV_DATA_LEN];
@@ -44,9 +46,9 @@ struct gapm_set_dev_config_cmd devConfigCmd =
     .att_cfg = GAPM_DEFAULT_ATT_CFG,
     .sugg_max_tx_octets = GAPM_DEFAULT_TX_OCT_MAX,
     .sugg_max_tx_time = GAPM_DEFAULT_TX_TIME_MAX,
-    .max_mtu = GAPM_DEFAULT_MTU_MAX,
-    .max_mps = GAPM_DEFAULT_MPS_MAX,
-    .max_nb_lecb = GAPM_DEFAULT_MAX_NB_LECB,
+    .max_mtu = APP_STREAM_MTU,
+    .max_mps = APP_LECB_MPS,
+    .max_nb_lecb = APP_LECB_NB,
     .audio_cfg = GAPM_DEFAULT_AUDIO_CFG,
     .tx_pref_phy = GAP_PHY_ANY,
     .rx_pref_phy = GAP_PHY_ANY
@@ -142,12 +144,12 @@ void BLE_ConfigHandler(ke_msg_id_t const msg_id, void const *param,
 
             if (p->operation == GAPM_RESET)    /* Step 2 */
             {
-                swmLogInfo("__GAPM_RESET completed. Setting BLE device configuration...\r\n");
+                APP_LOG_INFO("__GAPM_RESET completed. Setting BLE device configuration...\r\n");
 
                 /* Check privacy_cfg bit 0 to identify address type, public if not set*/
                 if (devConfigCmd.privacy_cfg & GAPM_CFG_ADDR_PRIVATE)
                 {
-                    swmLogInfo("	devConfigCmd address to set static private random\r\n");
+                    APP_LOG_DEBUG("	devConfigCmd address to set static private random\r\n");
                 }
                 else
                 {
@@ -159,14 +161,14 @@ void BLE_ConfigHandler(ke_msg_id_t const msg_id, void const *param,
                      * using Device_BLE_Public_Address_Read() before calling Device_BLE_Param_Get() */
                     Device_BLE_Param_Get(PARAM_ID_BD_ADDRESS, &ble_dev_addr_len, ble_dev_addr_buf);
 
-                    swmLogInfo("	Device BLE public address read: ");
+                    APP_LOG_DEBUG("	Device BLE public address read: ");
                     for (int i = 0; i < GAP_BD_ADDR_LEN; i++)
                     {
-                        swmLogInfo("0x%02x ", ble_dev_addr_buf[i]);
+                        APP_LOG_DEBUG("0x%02x ", ble_dev_addr_buf[i]);
                     }
-                    swmLogInfo("\r\n");
+                    APP_LOG_DEBUG("\r\n");
 
-                    swmLogInfo("	devConfigCmd address set to public\r\n");
+                    APP_LOG_DEBUG("	devConfigCmd address set to public\r\n");
                     memcpy(devConfigCmd.addr.addr, ble_dev_addr_buf, GAP_BD_ADDR_LEN);
                 }
 
@@ -181,7 +183,7 @@ void BLE_ConfigHandler(ke_msg_id_t const msg_id, void const *param,
             else if (p->operation == GAPM_SET_DEV_CONFIG &&
                      p->status == GAP_ERR_NO_ERROR)    /* Step 3 */
             {
-                swmLogInfo("__GAPM_SET_DEV_CONFIG completed.\r\n");
+                APP_LOG_INFO("__GAPM_SET_DEV_CONFIG completed.\r\n");
 
                 /* Request the stack to add our custom service server to the attribute database.
                  * The stack sends back a GATTM_ADD_SVC_RSP event. */
@@ -189,11 +191,16 @@ void BLE_ConfigHandler(ke_msg_id_t const msg_id, void const *param,
                 /* In parallel, the battery service server abstraction (BASS, ble_bass.c)
                  * also monitors this event and adds the standard profile to the database.
                  * See BASS_MsgHandler for details. */
-                swmLogInfo("    Adding BLE profiles and custom services...\r\n");
+                APP_LOG_INFO("    Adding BLE profiles and custom services...\r\n");
+
+#if (APP_L2CAP_OFFLOAD_ENABLE == 1)
+                /* Accept L2CAP channels for record upload, see l2cap_offload.h */
+                L2capOffload_Init();
+#endif    /* if (APP_L2CAP_OFFLOAD_ENABLE == 1) */
 
                 /* Request the stack to create an advertising activity.
                  * The stack sends back a GAPM_ACTIVITY_CREATED_IND. See ActivityHandler for next steps. */
-                swmLogInfo("    Creating Advertising activity...\r\n");
+                APP_LOG_INFO("    Creating Advertising activity...\r\n");
                 advParam.max_tx_pwr = tx_power_level_dbm;
                 GAPM_ActivityCreateAdvCmd(&advActivityStatus, GAPM_STATIC_ADDR, &advParam);
             }
@@ -202,15 +209,15 @@ void BLE_ConfigHandler(ke_msg_id_t const msg_id, void const *param,
 
         case GAPM_PROFILE_ADDED_IND:    /* Step 4 - BASS profile added */
         {
-            swmLogInfo("__GAPM_PROFILE_ADDED_IND - profile added count=%d\r\n",
-                       GAPM_GetProfileAddedCount());
+            APP_LOG_INFO("__GAPM_PROFILE_ADDED_IND - profile added count=%d\r\n",
+                         GAPM_GetProfileAddedCount());
         }
         break;
 
         case GATTM_ADD_SVC_RSP:    /* Step 5 - Custom service added */
         {
-            swmLogInfo("__GATTM_ADD_SVC_RSP - custom service added count=%d\r\n",
-                       GATTM_GetServiceAddedCount());
+            APP_LOG_INFO("__GATTM_ADD_SVC_RSP - custom service added count=%d\r\n",
+                         GATTM_GetServiceAddedCount());
         }
         break;
     }
@@ -225,9 +232,19 @@ void BLE_ActivityHandler(ke_msg_id_t const msg_id, void const *param,
         case GAPM_CMP_EVT:
         {
             const struct gapm_cmp_evt *p = param;
-            if (p->operation == GAPM_SET_ADV_DATA)    /* Step 7 */
+
+            /* The broadcast set follows its own commands, see broadcast.h */
+            if (Broadcast_Owns(p->actv_idx))
+            {
+                break;
+            }
+
+            /* Live updates of the advertising data complete here too,
+             * the activity is already running for those */
+            if (p->operation == GAPM_SET_ADV_DATA &&
+                !AdvData_Complete(p->status))    /* Step 7 */
             {
-                swmLogInfo("__GAPM_SET_ADV_DATA status = %d. Start advertising activity...\r\n", p->status);
+                APP_LOG_INFO("__GAPM_SET_ADV_DATA status = %d. Start advertising activity...\r\n", p->status);
                 GAPM_AdvActivityStart(advActivityStatus.actv_idx, 0, 0);
 
                 /* From now on, this device is advertising. Any peer device can
@@ -242,26 +259,33 @@ void BLE_ActivityHandler(ke_msg_id_t const msg_id, void const *param,
 
         case GAPM_ACTIVITY_CREATED_IND:    /* Step 6 */
         {
-            swmLogInfo("__GAPM_ACTIVITY_CREATED_IND actv_idx = %d. Setting adv and scan data...\r\n",
-                       advActivityStatus.actv_idx);
+            if (Broadcast_Owns(((const struct gapm_activity_created_ind *)param)->actv_idx))
+            {
+                break;
+            }
+
+            APP_LOG_INFO("__GAPM_ACTIVITY_CREATED_IND actv_idx = %d. Setting adv and scan data...\r\n",
+                         advActivityStatus.actv_idx);
 
             /* Request the stack to set the advertising and scan response data.
              * The stack sends back a GAPM_CMP_EVT: operation = GAPM_SET_ADV_DATA. */
-            GAPM_SetAdvDataCmd(GAPM_SET_SCAN_RSP_DATA, advActivityStatus.actv_idx,
-                               app_adv_data_len, app_adv_data);
-            GAPM_SetAdvDataCmd(GAPM_SET_ADV_DATA, advActivityStatus.actv_idx,
-                               app_adv_data_len, app_adv_data);
+            AdvData_Activity_Created(advActivityStatus.actv_idx);
         }
         break;
 
         case GAPM_ACTIVITY_STOPPED_IND:    /* Step 9(c) */
         {
+            if (Broadcast_Owns(((const struct gapm_activity_stopped_ind *)param)->actv_idx))
+            {
+                break;
+            }
+
             /* The advertising activity is stopped upon receiving
              * connection request. Restart advertising if not connected to
              * maximum number of peers configured for this application */
             if ((GAPC_ConnectionCount() < APP_MAX_NB_CON) && ble_adv_enable)
             {
-                swmLogInfo("__GAPM_ACTIVITY_STOPPED_IND.Restarting advertising...\r\n");
+                APP_LOG_INFO("__GAPM_ACTIVITY_STOPPED_IND.Restarting advertising...\r\n");
                 if (advActivityStatus.state == ACTIVITY_STATE_NOT_STARTED)
                 {
                     GAPM_AdvActivityStart(advActivityStatus.actv_idx, 0, 0);
@@ -282,17 +306,24 @@ void BLE_ConnectionHandler(ke_msg_id_t const msg_id, void const *param,
         {
             const struct gapc_connection_req_ind *p = param;
 
-            swmLogInfo("__GAPC_CONNECTION_REQ_IND conidx=%d\r\n", conidx);
+            APP_LOG_INFO("__GAPC_CONNECTION_REQ_IND conidx=%d\r\n", conidx);
+            AdvPolicy_On_Connection();
 
             /* If the peer device address is private resolvable and bond list is not empty */
             if (GAP_IsAddrPrivateResolvable(p->peer_addr.addr, p->peer_addr_type) &&
-                BondList_Size() > 0)    /* Step 9(a) */
+                BondCache_Size() > 0)    /* Step 9(a) */
             {
-                /* Ask the stack to resolve the address with the IRKs we have in our bond list.
-                 * In case of success, the stack returns GAPM_ADDR_SOLVED_IND.
+                /* Resolve the address with the IRKs we have in our bond list.
+                 * An address resolved recently is confirmed at once (see bond_cache.h).
+                 * Otherwise GAPM_ADDR_SOLVED_IND is received in case of success.
                  * If not successful (not bonded previously) the stack returns GAPM_CMP_EVT /
                  * GAPM_RESOLV_ADDR with status GAP_ERR_NOT_FOUND (see below). */
-                GAPM_ResolvAddrCmd(conidx, p->peer_addr.addr);
+                if (BondCache_Resolve(conidx, p->peer_addr.addr))
+                {
+                    struct gapc_connection_cfm cfm;
+                    SetConnectionCfmParams(conidx, &cfm);
+                    GAPC_ConnectionCfm(conidx, &cfm);
+                }
             }
             else    /* Step 9(b) */
             {
@@ -307,13 +338,14 @@ void BLE_ConnectionHandler(ke_msg_id_t const msg_id, void const *param,
 
         case GAPC_DISCONNECT_IND:
         {
-            swmLogInfo("__GAPC_DISCONNECT_IND: reason = %d\r\n",
-                       ((struct gapc_disconnect_ind *)param)->reason);
+            APP_LOG_INFO("__GAPC_DISCONNECT_IND: reason = %d\r\n",
+                         ((struct gapc_disconnect_ind *)param)->reason);
+            AdvPolicy_On_Disconnection();
             /* If advertising activity is stopped, restart advertising while
              * not connected to maximum number of peers for this application */
             if (GAPC_ConnectionCount() == (APP_MAX_NB_CON - 1))
             {
-                swmLogInfo("    Restarting advertising...\r\n");
+                APP_LOG_INFO("    Restarting advertising...\r\n");
                 GAPM_AdvActivityStart(advActivityStatus.actv_idx, 0, 0);
             }
         }
@@ -322,7 +354,7 @@ void BLE_ConnectionHandler(ke_msg_id_t const msg_id, void const *param,
         case GAPM_ADDR_SOLVED_IND:    /* Step 10(a) */
         {
             /* Private address resolution was successful */
-            swmLogInfo("__GAPM_ADDR_SOLVED_IND\r\n");
+            APP_LOG_INFO("__GAPM_ADDR_SOLVED_IND\r\n");
             struct gapc_connection_cfm cfm;
             conidx = KE_IDX_GET(dest_id);
 
@@ -352,9 +384,9 @@ void BLE_ConnectionHandler(ke_msg_id_t const msg_id, void const *param,
 
         case GAPC_PARAM_UPDATE_REQ_IND:    /* Step 11 */
         {
-            /* Peer device requested update in connection params. Accept it. */
-            GAPC_ParamUpdateCfm(conidx, true, 0xFFFF, 0xFFFF);
-            swmLogInfo("GAPC_PARAM_UPDATE_REQ_IND\r\n");
+            /* Peer device requested update in connection params. Accept it
+             * unless it costs too much power, see conn_policy.h */
+            ConnPolicy_Param_Update_Req(conidx, param);
         }
         break;
 
@@ -364,7 +396,7 @@ void BLE_ConnectionHandler(ke_msg_id_t const msg_id, void const *param,
              * appearance, slv pref. params). See getDevInfoCfm for details.  */
             const struct gapc_get_dev_info_req_ind *p = param;
             GAPC_GetDevInfoCfm(conidx, p->req, getDevInfoCfm[p->req]);
-            swmLogInfo("GAPC_GET_DEV_INFO_REQ_IND: req = %d\r\n", p->req);
+            APP_LOG_DEBUG("GAPC_GET_DEV_INFO_REQ_IND: req = %d\r\n", p->req);
         }
         break;
     }
@@ -383,7 +415,7 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
             {
                 case GAPC_PAIRING_REQ:
                 {
-                    bool accept = BondList_Size() < BONDLIST_MAX_SIZE;
+                    bool accept = BondCache_Size() < BONDLIST_MAX_SIZE;
 #if SECURE_CONNECTION
                     if (p->data.auth_req & GAP_AUTH_SEC_CON)
                     {
@@ -396,7 +428,7 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
                         pairingRsp.pairing_feat.auth = GAP_AUTH_REQ_NO_MITM_BOND;
                         pairingRsp.pairing_feat.sec_req = GAP_NO_SEC;
                     }
-                    swmLogInfo("__GAPC_BOND_REQ_IND / GAPC_PAIRING_REQ: accept = %d conidx=%d\r\n", accept, conidx);
+                    APP_LOG_INFO("__GAPC_BOND_REQ_IND / GAPC_PAIRING_REQ: accept = %d conidx=%d\r\n", accept, conidx);
                     GAPC_BondCfm(conidx, GAPC_PAIRING_RSP, accept, &pairingRsp);
                 }
                 break;
@@ -404,7 +436,7 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
                 case GAPC_LTK_EXCH:
                 {
                     /* Prepare and send random LTK (legacy only) */
-                    swmLogInfo("__GAPC_BOND_REQ_IND / GAPC_LTK_EXCH\r\n");
+                    APP_LOG_DEBUG("__GAPC_BOND_REQ_IND / GAPC_LTK_EXCH\r\n");
                     union gapc_bond_cfm_data ltkExch;
                     ltkExch.ltk.ediv = co_rand_hword();
                     for (uint8_t i = 0, i2 = GAP_RAND_NB_LEN; i < GAP_RAND_NB_LEN; i++, i2++)
@@ -419,7 +451,7 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
 
                 case GAPC_TK_EXCH:    /* Prepare and send TK */
                 {
-                    swmLogInfo("__GAPC_BOND_REQ_IND / GAPC_TK_EXCH\r\n");
+                    APP_LOG_DEBUG("__GAPC_BOND_REQ_IND / GAPC_TK_EXCH\r\n");
                     /* IO Capabilities are set to GAP_IO_CAP_NO_INPUT_NO_OUTPUT in this application.
                      * Therefore TK exchange is NOT performed. It is always set to 0 (Just Works algorithm). */
                 }
@@ -427,7 +459,7 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
 
                 case GAPC_IRK_EXCH:
                 {
-                    swmLogInfo("__GAPC_BOND_REQ_IND / GAPC_IRK_EXCH\rn");
+                    APP_LOG_DEBUG("__GAPC_BOND_REQ_IND / GAPC_IRK_EXCH\rn");
                     union gapc_bond_cfm_data irkExch;
                     memcpy(irkExch.irk.addr.addr.addr, GAPM_GetDeviceConfig()->addr.addr, GAP_BD_ADDR_LEN);
                     irkExch.irk.addr.addr_type = GAPM_GetDeviceConfig()->privacy_cfg;
@@ -438,7 +470,7 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
 
                 case GAPC_CSRK_EXCH:
                 {
-                    swmLogInfo("__GAPC_BOND_REQ_IND / GAPC_CSRK_EXCH\r\n");
+                    APP_LOG_DEBUG("__GAPC_BOND_REQ_IND / GAPC_CSRK_EXCH\r\n");
                     union gapc_bond_cfm_data csrkExch;
                     GAPC_BondCfm(conidx, GAPC_CSRK_EXCH, true, &csrkExch);    /* Send confirmation */
                 }
@@ -452,12 +484,14 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
             const struct gapc_bond_ind *p = param;
             if (p->info == GAPC_PAIRING_SUCCEED)
             {
-                swmLogInfo("__GAPC_BOND_IND / GAPC_PAIRING_SUCCEED\r\n");
-                GAPC_AddDeviceToBondList(conidx);
+                APP_LOG_INFO("__GAPC_BOND_IND / GAPC_PAIRING_SUCCEED\r\n");
+
+                /* Keep the keys in RAM, written to flash in batches */
+                BondCache_Add(conidx);
             }
             else if (p->info == GAPC_PAIRING_FAILED)
             {
-                swmLogError("__GAPC_BOND_IND / GAPC_PAIRING_FAILED reason=%d\r\n", p->data.reason);
+                APP_LOG_ERROR("__GAPC_BOND_IND / GAPC_PAIRING_FAILED reason=%d\r\n", p->data.reason);
             }
         }
         break;
@@ -471,14 +505,14 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
                           p->ediv == GAPC_GetBondInfo(conidx)->ediv &&
                           !memcmp(p->rand_nb.nb, GAPC_GetBondInfo(conidx)->rand, GAP_RAND_NB_LEN));
 
-            swmLogInfo("__GAPC_ENCRYPT_REQ_IND: bond information %s\r\n", (found ? "FOUND" : "NOT FOUND"));
+            APP_LOG_INFO("__GAPC_ENCRYPT_REQ_IND: bond information %s\r\n", (found ? "FOUND" : "NOT FOUND"));
             GAPC_EncryptCfm(conidx, found, GAPC_GetBondInfo(conidx)->ltk, GAP_KEY_LEN);
         }
         break;
 
         case GAPC_ENCRYPT_IND:    /* Step 14(b)  */
         {
-            swmLogInfo("__GAPC_ENCRYPT_IND: Link encryption is ON\r\n");
+            APP_LOG_INFO("__GAPC_ENCRYPT_IND: Link encryption is ON\r\n");
         }
         break;
     }
@@ -507,21 +541,16 @@ static void SetConnectionCfmParams(uint8_t conidx, struct gapc_connection_cfm *c
         cfm->lsign_counter = 0xFFFFFFFF;
         cfm->rsign_counter = 0;
     }
-    swmLogInfo("  connectionCfm->ltk_present = %d\r\n", cfm->ltk_present);
+    APP_LOG_DEBUG("  connectionCfm->ltk_present = %d\r\n", cfm->ltk_present);
 }
 
 void PrepareAdvScanData(void)
 {
     uint8_t companyID[] = APP_COMPANY_ID;
-    uint8_t devName[]   = APP_DEVICE_NAME;
 
-    /* Assemble advertising data as device name + company ID and
-     * copy into app_adv_data */
-    app_adv_data_len = 0;
-    GAP_AddAdvData(APP_DEVICE_NAME_LEN + 1, GAP_AD_TYPE_COMPLETE_NAME,
-                   devName, app_adv_data, &app_adv_data_len);
-    GAP_AddAdvData(APP_COMPANY_ID_LEN + 1, GAP_AD_TYPE_MANU_SPECIFIC_DATA,
-                   companyID, app_adv_data, &app_adv_data_len);
+    /* Assemble advertising data as device name + company ID + dynamic
+     * fields into app_adv_data, see adv_data.h */
+    AdvData_Build();
 
     /* Set scan response data as company ID */
     app_scan_rsp_data_len = 0;
@@ -0,0 +1,130 @@
+/**
+ * @file app_trace.c
+ * @brief Application trace source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+
+static uint32_t traceOptions[] = {
+    SWM_LOG_LEVEL_INFO,                 /* Levels are filtered by APP_LOG_ON() */
+    SWM_UART_RX_PIN | UART_RX_GPIO,     /* Set RX pin for cases when using UART */
+    SWM_UART_TX_PIN | UART_TX_GPIO,     /* Set TX pin for cases when using UART */
+    SWM_UART_RX_ENABLE,                 /* Enable the UART Rx Interrupts */
+    SWM_UART_BAUD_RATE | UART_BAUD      /* Set Baud rate */
+};
+
+static bool trace_ready = false;            /**< swmTrace initialized since last wakeup */
+static bool trace_pending = false;          /**< Logs emitted since last flush */
+static uint8_t trace_refcount = 0;          /**< Number of users holding the trace */
+
+uint8_t trace_level_mask = APP_LOG_MASK_ALL;    /**< Levels sent at runtime */
+
+void Trace_Open(void)
+{
+    GLOBAL_INT_DISABLE();
+
+    if (!trace_ready)
+    {
+        swmTrace_init(traceOptions, 5);
+        trace_ready = true;
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+bool Trace_Acquire(void)
+{
+    bool taken = false;
+
+    GLOBAL_INT_DISABLE();
+
+    /* Text must not be mixed with a deferred log transfer, the caller
+     * queues it behind the transfer */
+    if (!TraceLog_Busy())
+    {
+        trace_refcount++;
+        trace_pending = true;
+        taken = true;
+    }
+
+    GLOBAL_INT_RESTORE();
+
+    if (taken)
+    {
+        Trace_Open();
+    }
+
+    return taken;
+}
+
+void Trace_Release(void)
+{
+    GLOBAL_INT_DISABLE();
+
+    if (trace_refcount)
+    {
+        trace_refcount--;
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+bool Trace_Pending(void)
+{
+    return trace_pending;
+}
+
+void Trace_Invalidate(void)
+{
+    /* The UART lost its configuration, a user still holding the trace
+     * re-initializes it on its next Trace_Acquire() and its logs stay
+     * pending */
+    trace_ready = false;
+    trace_pending = (trace_refcount != 0);
+}
+
+void Trace_Set_Level_Mask(uint8_t mask)
+{
+    trace_level_mask = mask;
+}
+
+void Trace_Flush(void)
+{
+    if (!trace_pending || !trace_ready)
+    {
+        return;
+    }
+
+    uint64_t start = RTC_Get_Timestamp();
+
+    /* The UART TX interrupt refills the transmitter from the swmTrace
+     * software buffer as soon as a character is sent, and it preempts this
+     * loop. The buffer is empty and sent once the transmitter is idle with
+     * no TX interrupt left to run. Bounded by the RTC in case the UART was
+     * stopped. */
+    while (TRACE_UART_TX_BUSY() || TRACE_UART_TX_IRQ_PENDING())
+    {
+        if ((RTC_Get_Timestamp() - start) > TRACE_FLUSH_TIMEOUT_CYCLES)
+        {
+            break;
+        }
+    }
+
+    /* A user holding the trace may still add logs */
+    if (trace_refcount == 0)
+    {
+        trace_pending = false;
+    }
+}
@@ -0,0 +1,220 @@
+/**
+ * @file bond_cache.c
+ * @brief Bond cache source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <string.h>
+
+/**
+ * @brief Resolved address and the IRK that resolved it
+ */
+typedef struct
+{
+    uint8_t addr[GAP_BD_ADDR_LEN];
+    uint8_t irk_idx;
+    uint8_t valid;
+    uint32_t last_use;
+} bond_cache_rpa_t;
+
+static struct gap_sec_key bond_cache_irk[BONDLIST_MAX_SIZE];
+static uint8_t bond_cache_irk_nb = 0;
+
+static bond_cache_rpa_t bond_cache_rpa[BOND_CACHE_RPA_NB];
+static uint32_t bond_cache_use = 0;
+
+/* Bonds paired since the last flush, the keys of a link are released with
+ * it */
+static BondInfo_Type bond_cache_pending[BOND_CACHE_PENDING_NB];
+static uint8_t bond_cache_pending_nb = 0;
+
+static bond_cache_stats_t bond_cache_stats;
+
+/**
+ * @brief Index of an IRK in the cache
+ */
+static uint8_t BondCache_Find_IRK(const struct gap_sec_key *irk)
+{
+    for (uint8_t i = 0; i < bond_cache_irk_nb; i++)
+    {
+        if (!memcmp(bond_cache_irk[i].key, irk->key, GAP_KEY_LEN))
+        {
+            return i;
+        }
+    }
+
+    return BONDLIST_MAX_SIZE;
+}
+
+/**
+ * @brief Reload the IRKs from the bond list
+ */
+static void BondCache_Load_IRKs(void)
+{
+    struct gap_sec_key old_irk[BONDLIST_MAX_SIZE];
+
+    memcpy(old_irk, bond_cache_irk, sizeof(old_irk));
+    bond_cache_irk_nb = BondList_GetIRKs(bond_cache_irk);
+
+    /* A write may move IRKs in the list, follow them and forget only the
+     * addresses of IRKs no longer bonded */
+    for (uint8_t i = 0; i < BOND_CACHE_RPA_NB; i++)
+    {
+        bond_cache_rpa_t *e = &bond_cache_rpa[i];
+
+        if (e->valid)
+        {
+            e->irk_idx = BondCache_Find_IRK(&old_irk[e->irk_idx]);
+            if (e->irk_idx == BONDLIST_MAX_SIZE)
+            {
+                e->valid = 0;
+            }
+        }
+    }
+}
+
+void BondCache_Init(void)
+{
+    memset(&bond_cache_stats, 0, sizeof(bond_cache_stats));
+    memset(bond_cache_rpa, 0, sizeof(bond_cache_rpa));
+    bond_cache_pending_nb = 0;
+    BondCache_Load_IRKs();
+}
+
+uint8_t BondCache_Size(void)
+{
+    return BondList_Size() + bond_cache_pending_nb;
+}
+
+void BondCache_Flush(void)
+{
+    if (bond_cache_pending_nb == 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < bond_cache_pending_nb; i++)
+    {
+        BondList_Add(&bond_cache_pending[i]);
+    }
+
+    bond_cache_stats.bonds_written += bond_cache_pending_nb;
+    bond_cache_stats.flushes++;
+    bond_cache_pending_nb = 0;
+
+    BondCache_Load_IRKs();
+}
+
+bool BondCache_Resolve(uint8_t conidx, const uint8_t *addr)
+{
+    /* The stack looks the resolved IRK up in the bond list */
+    BondCache_Flush();
+
+    for (uint8_t i = 0; i < BOND_CACHE_RPA_NB; i++)
+    {
+        bond_cache_rpa_t *e = &bond_cache_rpa[i];
+
+        if (e->valid && !memcmp(e->addr, addr, GAP_BD_ADDR_LEN))
+        {
+            /* Same answer as the stack would give, without the AES run
+             * over every IRK */
+            e->last_use = ++bond_cache_use;
+            bond_cache_stats.rpa_hits++;
+            return true;
+        }
+    }
+
+    /* Resolve with the IRKs in RAM instead of reading the bond list */
+    struct gapm_resolv_addr_cmd *cmd = KE_MSG_ALLOC_DYN(GAPM_RESOLV_ADDR_CMD, TASK_GAPM,
+                                                        KE_BUILD_ID(TASK_APP, conidx),
+                                                        gapm_resolv_addr_cmd,
+                                                        bond_cache_irk_nb * sizeof(struct gap_sec_key));
+    cmd->operation = GAPM_RESOLV_ADDR;
+    cmd->nb_key = bond_cache_irk_nb;
+    memcpy(cmd->addr.addr, addr, GAP_BD_ADDR_LEN);
+    memcpy(cmd->irk, bond_cache_irk, bond_cache_irk_nb * sizeof(struct gap_sec_key));
+    ke_msg_send(cmd);
+
+    bond_cache_stats.rpa_misses++;
+    return false;
+}
+
+void BondCache_Add(uint8_t conidx)
+{
+    if (bond_cache_pending_nb == BOND_CACHE_PENDING_NB)
+    {
+        BondCache_Flush();
+    }
+
+    /* Copied while the keys of the link are valid */
+    memcpy(&bond_cache_pending[bond_cache_pending_nb++], GAPC_GetBondInfo(conidx),
+           sizeof(BondInfo_Type));
+}
+
+void BondCache_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                          ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    if (msg_id == GAPC_DISCONNECT_IND)
+    {
+        /* A peer reconnects after its link is released, its bond is in
+         * flash by then */
+        BondCache_Flush();
+    }
+    else if (msg_id == GAPM_ADDR_SOLVED_IND)
+    {
+        const struct gapm_addr_solved_ind *p = param;
+        uint8_t irk_idx = BondCache_Find_IRK(&p->irk);
+        bond_cache_rpa_t *e = &bond_cache_rpa[0];
+
+        if (irk_idx == BONDLIST_MAX_SIZE)
+        {
+            return;
+        }
+
+        /* Replace the address used least recently */
+        for (uint8_t i = 0; i < BOND_CACHE_RPA_NB; i++)
+        {
+            if (!bond_cache_rpa[i].valid ||
+                !memcmp(bond_cache_rpa[i].addr, p->addr.addr, GAP_BD_ADDR_LEN))
+            {
+                e = &bond_cache_rpa[i];
+                break;
+            }
+
+            if (bond_cache_rpa[i].last_use < e->last_use)
+            {
+                e = &bond_cache_rpa[i];
+            }
+        }
+
+        memcpy(e->addr, p->addr.addr, GAP_BD_ADDR_LEN);
+        e->irk_idx = irk_idx;
+        e->valid = 1;
+        e->last_use = ++bond_cache_use;
+    }
+}
+
+const bond_cache_stats_t * BondCache_Get_Stats(void)
+{
+    return &bond_cache_stats;
+}
+
+void BondCache_Log_Stats(void)
+{
+    const bond_cache_stats_t *b = BondCache_Get_Stats();
+
+    TRACE_LOG("STAT bond hits=%lu misses=%lu written=%lu flushes=%lu\r\n",
+              b->rpa_hits, b->rpa_misses, b->bonds_written, b->flushes);
+}
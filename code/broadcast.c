@@ -0,0 +1,255 @@
+/**
+ * @file broadcast.c
+ * @brief Broadcast source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <string.h>
+
+/**
+ * @brief Broadcast set state
+ */
+typedef enum
+{
+    BROADCAST_NOT_CREATED = 0,
+    BROADCAST_CREATING,
+    BROADCAST_IDLE,
+    BROADCAST_UPDATING,
+    BROADCAST_RUNNING
+} broadcast_state_t;
+
+static broadcast_state_t bcast_state = BROADCAST_NOT_CREATED;
+static uint8_t bcast_actv_idx = 0xFF;
+static bool bcast_pending = false;          /**< Records added since last update */
+
+/* Manufacturer specific AD structure: length, type, company ID, records */
+static uint8_t bcast_data[BROADCAST_ADV_DATA_LEN];
+static uint8_t bcast_records_nb = 0;
+
+static broadcast_stats_t bcast_stats;
+
+/**
+ * @brief Create the extended advertising set with periodic advertising
+ */
+static void Broadcast_Create(void)
+{
+    struct gapm_activity_create_adv_cmd *cmd;
+
+    cmd = KE_MSG_ALLOC(GAPM_ACTIVITY_CREATE_CMD, TASK_GAPM,
+                       KE_BUILD_ID(TASK_APP, BROADCAST_TASK_IDX),
+                       gapm_activity_create_adv_cmd);
+    cmd->operation = GAPM_CREATE_ADV_ACTIVITY;
+    cmd->own_addr_type = GAPM_STATIC_ADDR;
+    cmd->adv_param.type = GAPM_ADV_TYPE_PERIODIC;
+    cmd->adv_param.disc_mode = GAPM_ADV_MODE_NON_DISC;
+    cmd->adv_param.prop = GAPM_ADV_PROP_NON_CONN_NON_SCAN_MASK;
+    cmd->adv_param.max_tx_pwr = tx_power_level_dbm;
+    cmd->adv_param.filter_pol = ADV_ALLOW_SCAN_ANY_CON_ANY;
+    cmd->adv_param.prim_cfg.adv_intv_min = BROADCAST_ADV_INT;
+    cmd->adv_param.prim_cfg.adv_intv_max = BROADCAST_ADV_INT;
+    cmd->adv_param.prim_cfg.chnl_map = APP_ADV_CHMAP;
+    cmd->adv_param.prim_cfg.phy = GAPM_PHY_TYPE_LE_1M;
+    cmd->adv_param.second_cfg.max_skip = 0;
+    cmd->adv_param.second_cfg.phy = GAPM_PHY_TYPE_LE_1M;
+    cmd->adv_param.second_cfg.adv_sid = BROADCAST_ADV_SID;
+    cmd->adv_param.period_cfg.adv_intv_min = BROADCAST_PER_ADV_INT;
+    cmd->adv_param.period_cfg.adv_intv_max = BROADCAST_PER_ADV_INT;
+    ke_msg_send(cmd);
+
+    bcast_state = BROADCAST_CREATING;
+}
+
+/**
+ * @brief Stop the broadcast set before its data is replaced
+ */
+static void Broadcast_Stop(void)
+{
+    struct gapm_activity_stop_cmd *cmd;
+
+    cmd = KE_MSG_ALLOC(GAPM_ACTIVITY_STOP_CMD, TASK_GAPM, TASK_APP,
+                       gapm_activity_stop_cmd);
+    cmd->operation = GAPM_STOP_ACTIVITY;
+    cmd->actv_idx = bcast_actv_idx;
+    ke_msg_send(cmd);
+}
+
+/**
+ * @brief Send the records as extended and periodic advertising data
+ */
+static void Broadcast_Set_Data(void)
+{
+    uint8_t companyID[] = APP_COMPANY_ID;
+    uint8_t len = 2 + APP_COMPANY_ID_LEN + bcast_records_nb * sizeof(broadcast_record_t);
+
+    bcast_data[0] = len - 1;
+    bcast_data[1] = GAP_AD_TYPE_MANU_SPECIFIC_DATA;
+    memcpy(&bcast_data[2], companyID, APP_COMPANY_ID_LEN);
+
+    /* Periodic advertising carries the records for synchronized scanners,
+     * the extended advertising lets other scanners read them too. The stack
+     * sends back a GAPM_CMP_EVT for each, the last one starts the set. */
+    GAPM_SetAdvDataCmd(GAPM_SET_ADV_DATA, bcast_actv_idx, len, bcast_data);
+    GAPM_SetAdvDataCmd(GAPM_SET_PERIOD_ADV_DATA, bcast_actv_idx, len, bcast_data);
+
+    bcast_pending = false;
+    bcast_state = BROADCAST_UPDATING;
+    bcast_stats.updates++;
+}
+
+void Broadcast_Add_Record(const broadcast_record_t *rec)
+{
+    broadcast_record_t *records = (broadcast_record_t *)&bcast_data[2 + APP_COMPANY_ID_LEN];
+
+    /* Drop the oldest record to keep the latest ones */
+    if (bcast_records_nb == BROADCAST_RECORDS_NB)
+    {
+        memmove(records, &records[1], (BROADCAST_RECORDS_NB - 1) * sizeof(broadcast_record_t));
+        bcast_records_nb--;
+        bcast_stats.dropped++;
+    }
+
+    records[bcast_records_nb++] = *rec;
+    bcast_pending = true;
+    bcast_stats.records++;
+}
+
+void Broadcast_Update(void)
+{
+    switch (bcast_state)
+    {
+        case BROADCAST_NOT_CREATED:
+        {
+            Broadcast_Create();
+        }
+        break;
+
+        case BROADCAST_IDLE:
+        {
+            if (bcast_pending)
+            {
+                Broadcast_Set_Data();
+            }
+        }
+        break;
+
+        case BROADCAST_RUNNING:
+        {
+            /* Data is set again once stopped */
+            if (bcast_pending)
+            {
+                Broadcast_Stop();
+            }
+        }
+        break;
+
+        default:
+        {
+            /* Picked up when the current command completes */
+        }
+        break;
+    }
+}
+
+bool Broadcast_Owns(uint8_t actv_idx)
+{
+    return (bcast_state != BROADCAST_NOT_CREATED) && (actv_idx == bcast_actv_idx);
+}
+
+void Broadcast_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                          ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    switch (msg_id)
+    {
+        case GAPM_ACTIVITY_CREATED_IND:
+        {
+            const struct gapm_activity_created_ind *p = param;
+
+            /* The connectable set may be created at the same time */
+            if ((bcast_state == BROADCAST_CREATING) &&
+                (p->actv_type == GAPM_ACTV_TYPE_ADV) &&
+                (KE_IDX_GET(dest_id) == BROADCAST_TASK_IDX))
+            {
+                bcast_actv_idx = p->actv_idx;
+                bcast_state = BROADCAST_IDLE;
+                Broadcast_Update();
+            }
+        }
+        break;
+
+        case GAPM_ACTIVITY_STOPPED_IND:
+        {
+            const struct gapm_activity_stopped_ind *p = param;
+
+            if (Broadcast_Owns(p->actv_idx))
+            {
+                bcast_state = BROADCAST_IDLE;
+                Broadcast_Update();
+            }
+        }
+        break;
+
+        case GAPM_CMP_EVT:
+        {
+            const struct gapm_cmp_evt *p = param;
+
+            if (p->operation == GAPM_CREATE_ADV_ACTIVITY)
+            {
+                if ((bcast_state == BROADCAST_CREATING) &&
+                    (KE_IDX_GET(dest_id) == BROADCAST_TASK_IDX) &&
+                    (p->status != GAP_ERR_NO_ERROR))
+                {
+                    bcast_stats.errors++;
+                    bcast_state = BROADCAST_NOT_CREATED;
+                }
+                break;
+            }
+
+            if (!Broadcast_Owns(p->actv_idx))
+            {
+                break;
+            }
+
+            if (p->status != GAP_ERR_NO_ERROR)
+            {
+                /* Retried with the next update */
+                bcast_stats.errors++;
+                bcast_pending = true;
+                bcast_state = BROADCAST_IDLE;
+            }
+            else if (p->operation == GAPM_SET_PERIOD_ADV_DATA &&
+                     bcast_state == BROADCAST_UPDATING)
+            {
+                /* Stops by itself after the duration, periodic advertising
+                 * with it */
+                GAPM_AdvActivityStart(bcast_actv_idx, BROADCAST_DURATION, 0);
+                bcast_state = BROADCAST_RUNNING;
+            }
+        }
+        break;
+    }
+}
+
+const broadcast_stats_t * Broadcast_Get_Stats(void)
+{
+    return &bcast_stats;
+}
+
+void Broadcast_Log_Stats(void)
+{
+    const broadcast_stats_t *b = Broadcast_Get_Stats();
+
+    TRACE_LOG("STAT bcast records=%lu dropped=%lu updates=%lu errors=%lu\r\n",
+              b->records, b->dropped, b->updates, b->errors);
+}
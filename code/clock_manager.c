@@ -0,0 +1,154 @@
+/**
+ * @file clock_manager.c
+ * @brief System clock manager source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+
+static const uint32_t clock_freq[CLOCK_LEVEL_NB] =
+{
+    [CLOCK_LEVEL_8MHZ] = 8000000,
+    [CLOCK_LEVEL_16MHZ] = 16000000,
+    [CLOCK_LEVEL_24MHZ] = 24000000,
+    [CLOCK_LEVEL_48MHZ] = 48000000
+};
+
+static clock_level_t clock_level = CLOCK_LEVEL_LOW;
+static clock_level_t clock_request[CLOCK_USER_NB];
+static clock_stats_t clock_stats;
+
+/**
+ * @brief Switch the system clock and keep the UART, sensor, user and
+ *        baseband clocks unchanged
+ */
+static void Clock_Apply(clock_level_t level)
+{
+    uint32_t freq = clock_freq[level];
+
+    /* Characters being sent would be corrupted by the divider change */
+    Trace_Flush();
+
+    GLOBAL_INT_DISABLE();
+
+    /* Profiler durations are converted with the clock they ran at */
+    Profiler_Clock_Change();
+
+    /* Same sequence as App_Clock_Config() */
+    Sys_Clocks_XTALClkConfig(RFCLK_BASE_FREQ / freq);
+    Sys_Clocks_SystemClkConfig(SYSCLK_CLKSRC_RFCLK);
+
+    /* Dividers are computed from the new SystemCoreClock */
+    Sys_Clocks_DividerConfig(UART_CLK, SENSOR_CLK, USER_CLK);
+
+    /* Baseband clock stays at CLOCK_BBCLK_FREQ */
+    BBIF->CTRL = (BBIF->CTRL & ~BBIF_CTRL_BBCLK_DIVIDER_Mask) | CLOCK_BBCLK_DIVIDER(freq);
+
+    clock_level = level;
+    clock_stats.switches++;
+
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ * @brief Highest level requested by all users
+ */
+static clock_level_t Clock_Target(void)
+{
+    clock_level_t target = CLOCK_LEVEL_LOW;
+
+    for (uint8_t i = 0; i < CLOCK_USER_NB; i++)
+    {
+        if (clock_request[i] > target)
+        {
+            target = clock_request[i];
+        }
+    }
+
+    return target;
+}
+
+void Clock_Request(clock_user_t user, clock_level_t level)
+{
+#if CLOCK_SCALING_ENABLE
+    clock_request[user] = level;
+    clock_stats.requests[level]++;
+
+    clock_level_t target = Clock_Target();
+
+    /* Lowering is left to Clock_Idle(), back to back tasks keep the clock */
+    if (target > clock_level)
+    {
+        /* A trace DMA transfer would be corrupted by the UART divider change */
+        if (!TraceLog_Busy())
+        {
+            Clock_Apply(target);
+        }
+        else
+        {
+            clock_stats.denied++;
+        }
+    }
+#endif    /* if CLOCK_SCALING_ENABLE */
+}
+
+void Clock_Idle(void)
+{
+#if CLOCK_SCALING_ENABLE
+    clock_level_t target = Clock_Target();
+
+    /* A trace DMA transfer keeps the clock, sleep restores SYSTEM_CLK */
+    if ((target < clock_level) && !TraceLog_Busy())
+    {
+        Clock_Apply(target);
+    }
+#endif    /* if CLOCK_SCALING_ENABLE */
+}
+
+clock_level_t Clock_Get_Level(void)
+{
+    return clock_level;
+}
+
+void Clock_Sleep_Exit(void)
+{
+    /* app_sleep_mode_cfg.clock_cfg brought SYSTEM_CLK back, the baseband
+     * divider of a raised level would be left behind */
+    if (clock_level != CLOCK_LEVEL_LOW)
+    {
+        BBIF->CTRL = (BBIF->CTRL & ~BBIF_CTRL_BBCLK_DIVIDER_Mask) | CLOCK_BBCLK_DIVIDER(SYSTEM_CLK);
+    }
+
+    clock_level = CLOCK_LEVEL_LOW;
+
+    for (uint8_t i = 0; i < CLOCK_USER_NB; i++)
+    {
+        clock_request[i] = CLOCK_LEVEL_LOW;
+    }
+}
+
+const clock_stats_t * Clock_Get_Stats(void)
+{
+    return &clock_stats;
+}
+
+void Clock_Log_Stats(void)
+{
+    const clock_stats_t *c = Clock_Get_Stats();
+
+    TRACE_LOG("STAT clock switches=%lu denied=%lu requests %lu %lu %lu %lu\r\n",
+              c->switches, c->denied, c->requests[CLOCK_LEVEL_8MHZ],
+              c->requests[CLOCK_LEVEL_16MHZ], c->requests[CLOCK_LEVEL_24MHZ],
+              c->requests[CLOCK_LEVEL_48MHZ]);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file conn_policy.c
+ * @brief Connection parameter policy source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  BLE
+
+#include "app.h"
+
+/**
+ * @brief Per link state
+ */
+typedef struct
+{
+    bool active;
+    bool bulk;
+    uint8_t rejects;                        /**< Consecutive peer requests rejected */
+    uint8_t bucket;                         /**< Bucket of the current interval */
+    uint16_t interval;                      /**< Current interval (units of 1.25 ms) */
+    uint16_t latency;                       /**< Current slave latency */
+    uint64_t since;                         /**< Parameters applied at (RTC cycles) */
+} conn_policy_link_t;
+
+static const uint16_t conn_policy_bounds[CONN_POLICY_BUCKET_NB - 1] = CONN_POLICY_BUCKET_BOUNDS;
+
+static conn_policy_link_t conn_policy_link[BLE_CONNECTION_MAX];
+static conn_policy_stats_t conn_policy_stats;
+
+/**
+ * @brief Bucket of a connection interval
+ */
+static uint8_t ConnPolicy_Bucket(uint16_t interval)
+{
+    uint8_t i;
+
+    for (i = 0; i < (CONN_POLICY_BUCKET_NB - 1); i++)
+    {
+        if (interval <= conn_policy_bounds[i])
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief Account the time spent at the current parameters of a link
+ */
+static void ConnPolicy_Account(conn_policy_link_t *link)
+{
+    uint64_t now = RTC_Get_Timestamp();
+
+    if (link->active)
+    {
+        conn_policy_stats.time_at_interval[link->bucket] += now - link->since;
+    }
+    link->since = now;
+}
+
+/**
+ * @brief Record the parameters in use on a link
+ */
+static void ConnPolicy_Apply(uint8_t conidx, uint16_t interval, uint16_t latency)
+{
+    conn_policy_link_t *link = &conn_policy_link[conidx];
+
+    ConnPolicy_Account(link);
+    link->interval = interval;
+    link->latency = latency;
+    link->bucket = ConnPolicy_Bucket(interval);
+}
+
+/**
+ * @brief Ask the central for new connection parameters
+ */
+static void ConnPolicy_Request(uint8_t conidx, uint16_t intv_min, uint16_t intv_max,
+                               uint16_t latency, uint16_t time_out)
+{
+    struct gapc_param_update_cmd *cmd;
+
+    cmd = KE_MSG_ALLOC(GAPC_PARAM_UPDATE_CMD, KE_BUILD_ID(TASK_GAPC, conidx),
+                       TASK_APP, gapc_param_update_cmd);
+    cmd->operation = GAPC_UPDATE_PARAMS;
+    cmd->intv_min = intv_min;
+    cmd->intv_max = intv_max;
+    cmd->latency = latency;
+    cmd->time_out = time_out;
+    cmd->ce_len_min = 0xFFFF;
+    cmd->ce_len_max = 0xFFFF;
+    ke_msg_send(cmd);
+
+    conn_policy_stats.own_requests++;
+}
+
+void ConnPolicy_Set_Bulk(uint8_t conidx, bool bulk)
+{
+    conn_policy_link_t *link;
+
+    if ((conidx >= BLE_CONNECTION_MAX) || !conn_policy_link[conidx].active)
+    {
+        return;
+    }
+
+    link = &conn_policy_link[conidx];
+
+    if (bulk)
+    {
+        ke_timer_clear(CONN_POLICY_IDLE_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx));
+
+        if (!link->bulk && (link->interval > CONN_POLICY_BULK_INTV_MAX))
+        {
+            ConnPolicy_Request(conidx, CONN_POLICY_BULK_INTV_MIN, CONN_POLICY_BULK_INTV_MAX,
+                               CONN_POLICY_BULK_LATENCY, CONN_POLICY_BULK_SUP_TIMEOUT);
+        }
+    }
+    else
+    {
+        ke_timer_set(CONN_POLICY_IDLE_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx),
+                     TIMER_SETTING_MS(CONN_POLICY_IDLE_DELAY_MS));
+    }
+
+    link->bulk = bulk;
+}
+
+void ConnPolicy_Param_Update_Req(uint8_t conidx, const void *param)
+{
+    const struct gapc_param_update_req_ind *p = param;
+    conn_policy_link_t *link = &conn_policy_link[conidx];
+    uint32_t period = (uint32_t)p->intv_max * (1 + p->latency);
+    bool accept = true;
+
+    conn_policy_stats.peer_requests++;
+
+    /* While idle, refuse to listen more often than needed, a bulk transfer
+     * takes whatever the central offers */
+    if (!link->bulk && (period < CONN_POLICY_PEER_MIN_PERIOD) &&
+        (link->rejects < CONN_POLICY_MAX_REJECTS))
+    {
+        accept = false;
+        link->rejects++;
+        conn_policy_stats.peer_rejected++;
+    }
+    else
+    {
+        link->rejects = 0;
+    }
+
+    GAPC_ParamUpdateCfm(conidx, accept, 0xFFFF, 0xFFFF);
+    APP_LOG_INFO("GAPC_PARAM_UPDATE_REQ_IND: intv %d-%d latency %d %s\r\n",
+                 p->intv_min, p->intv_max, p->latency, accept ? "accepted" : "rejected");
+}
+
+void ConnPolicy_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                           ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    switch (msg_id)
+    {
+        case GAPC_CONNECTION_REQ_IND:
+        {
+            const struct gapc_connection_req_ind *p = param;
+            uint8_t conidx = KE_IDX_GET(src_id);
+            conn_policy_link_t *link = &conn_policy_link[conidx];
+
+            link->active = false;
+            ConnPolicy_Apply(conidx, p->con_interval, p->con_latency);
+            link->active = true;
+            link->bulk = false;
+            link->rejects = 0;
+
+            ke_timer_set(CONN_POLICY_IDLE_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx),
+                         TIMER_SETTING_MS(CONN_POLICY_IDLE_DELAY_MS));
+        }
+        break;
+
+        case GAPC_PARAM_UPDATED_IND:
+        {
+            const struct gapc_param_updated_ind *p = param;
+
+            ConnPolicy_Apply(KE_IDX_GET(src_id), p->con_interval, p->con_latency);
+            conn_policy_stats.updates++;
+        }
+        break;
+
+        case GAPC_DISCONNECT_IND:
+        {
+            uint8_t conidx = KE_IDX_GET(src_id);
+
+            ConnPolicy_Account(&conn_policy_link[conidx]);
+            conn_policy_link[conidx].active = false;
+            ke_timer_clear(CONN_POLICY_IDLE_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx));
+        }
+        break;
+
+        case CONN_POLICY_IDLE_TIMEOUT:
+        {
+            uint8_t conidx = KE_IDX_GET(dest_id);
+            conn_policy_link_t *link = &conn_policy_link[conidx];
+
+            if (link->active && !link->bulk &&
+                ((link->interval < CONN_POLICY_IDLE_INTV_MIN) ||
+                 (link->latency < CONN_POLICY_IDLE_LATENCY)))
+            {
+                ConnPolicy_Request(conidx, CONN_POLICY_IDLE_INTV_MIN, CONN_POLICY_IDLE_INTV_MAX,
+                                   CONN_POLICY_IDLE_LATENCY, CONN_POLICY_IDLE_SUP_TIMEOUT);
+            }
+        }
+        break;
+    }
+}
+
+const conn_policy_stats_t * ConnPolicy_Get_Stats(void)
+{
+    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        ConnPolicy_Account(&conn_policy_link[i]);
+    }
+
+    return &conn_policy_stats;
+}
+
+void ConnPolicy_Log_Stats(void)
+{
+    const conn_policy_stats_t *c = ConnPolicy_Get_Stats();
+
+    TRACE_LOG("STAT connpol peer=%lu rejected=%lu own=%lu updates=%lu\r\n",
+              c->peer_requests, c->peer_rejected, c->own_requests, c->updates);
+    TRACE_LOG("STAT connpol ms %lu %lu %lu %lu %lu %lu %lu %lu\r\n",
+              STATS_REPORT_MS(c->time_at_interval[0]), STATS_REPORT_MS(c->time_at_interval[1]),
+              STATS_REPORT_MS(c->time_at_interval[2]), STATS_REPORT_MS(c->time_at_interval[3]),
+              STATS_REPORT_MS(c->time_at_interval[4]), STATS_REPORT_MS(c->time_at_interval[5]),
+              STATS_REPORT_MS(c->time_at_interval[6]), STATS_REPORT_MS(c->time_at_interval[7]));
+}
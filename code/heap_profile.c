@@ -0,0 +1,84 @@
+/**
+ * @file heap_profile.c
+ * @brief BLE heap profile source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  DIAG
+
+#include "app.h"
+
+static heap_profile_t heap_profile =
+{
+    .size =
+    {
+        [HEAP_PROFILE_ENV] = APP_RWIP_HEAP_ENV_SIZE,
+        [HEAP_PROFILE_DB] = APP_RWIP_HEAP_DB_SIZE,
+        [HEAP_PROFILE_MSG] = APP_RWIP_HEAP_MSG_SIZE,
+        [HEAP_PROFILE_NON_RET] = APP_RWIP_HEAP_NON_RET_SIZE
+    }
+};
+
+static const uint8_t heap_profile_type[HEAP_PROFILE_NB] =
+{
+    [HEAP_PROFILE_ENV] = KE_MEM_ENV,
+    [HEAP_PROFILE_DB] = KE_MEM_ATT_DB,
+    [HEAP_PROFILE_MSG] = KE_MEM_KE_MSG,
+    [HEAP_PROFILE_NON_RET] = KE_MEM_NON_RETENTION
+};
+
+const heap_profile_t * HeapProfile_Get(void)
+{
+    uint8_t con = GAPC_ConnectionCount();
+
+    /* The kernel keeps the peak of each heap */
+    for (uint8_t i = 0; i < HEAP_PROFILE_NB; i++)
+    {
+        heap_profile.peak[i] = ke_get_mem_usage(heap_profile_type[i]);
+    }
+
+    if (con > heap_profile.max_con)
+    {
+        heap_profile.max_con = con;
+    }
+
+    return &heap_profile;
+}
+
+void HeapProfile_Dump(void)
+{
+    const heap_profile_t *p = HeapProfile_Get();
+
+    APP_LOG_INFO("HEAPPROF %u %u %u %u %u %u %u %u %u\r\n", p->max_con,
+                 p->size[HEAP_PROFILE_ENV], p->peak[HEAP_PROFILE_ENV],
+                 p->size[HEAP_PROFILE_DB], p->peak[HEAP_PROFILE_DB],
+                 p->size[HEAP_PROFILE_MSG], p->peak[HEAP_PROFILE_MSG],
+                 p->size[HEAP_PROFILE_NON_RET], p->peak[HEAP_PROFILE_NON_RET]);
+}
+
+void HeapProfile_Dump_Periodic(void)
+{
+#if HEAP_PROFILE_LOG_PERIOD
+    static uint16_t heap_profile_log_count = 0;
+
+    /* Connection count is sampled on every call */
+    HeapProfile_Get();
+
+    if (++heap_profile_log_count >= HEAP_PROFILE_LOG_PERIOD)
+    {
+        heap_profile_log_count = 0;
+        HeapProfile_Dump();
+    }
+#endif    /* if HEAP_PROFILE_LOG_PERIOD */
+}
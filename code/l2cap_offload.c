@@ -0,0 +1,374 @@
+/**
+ * @file l2cap_offload.c
+ * @brief L2CAP offload source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  BLE
+
+#include "app.h"
+#include <string.h>
+
+/**
+ * @brief Per link channel state
+ */
+typedef struct
+{
+    bool connected;
+    bool running;
+    uint16_t cid;                           /**< Local channel ID */
+    uint16_t peer_mtu;                      /**< Largest SDU the peer accepts */
+    uint16_t peer_mps;                      /**< Largest K-frame payload the peer accepts */
+    uint16_t peer_credits;                  /**< K-frames the peer can still receive */
+    uint8_t in_flight;                      /**< SDUs given to the stack */
+    uint8_t sdu_head;                       /**< Oldest SDU given to the stack */
+    uint32_t sdu_end[APP_LECB_SDU_IN_FLIGHT];   /**< Offset after each SDU given to the stack */
+    uint32_t offset;                        /**< Offset of the next data to send */
+    uint32_t resume_offset;                 /**< End of the last SDU sent, kept until the link is lost */
+} l2cap_offload_link_t;
+
+static l2cap_offload_link_t l2cap_link[BLE_CONNECTION_MAX];
+static l2cap_offload_source_t l2cap_source = NULL;
+static l2cap_offload_stats_t l2cap_stats;
+
+/**
+ * @brief Built-in test records, an incrementing byte pattern
+ */
+static uint16_t L2capOffload_Pattern(uint32_t offset, uint8_t *buf, uint16_t max_len)
+{
+    uint32_t left = (offset < L2CAP_OFFLOAD_TEST_LENGTH) ? (L2CAP_OFFLOAD_TEST_LENGTH - offset) : 0;
+    uint16_t len = (left < max_len) ? (uint16_t)left : max_len;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)(offset + i);
+    }
+
+    return len;
+}
+
+/**
+ * @brief Number of K-frames, and so credits, needed for an SDU. The first
+ *        K-frame carries the 2 bytes SDU length.
+ */
+static uint16_t L2capOffload_Frames(const l2cap_offload_link_t *link, uint16_t sdu_len)
+{
+    return (sdu_len + 2 + link->peer_mps - 1) / link->peer_mps;
+}
+
+/**
+ * @brief SDU size for a link. SDUs longer than one K-frame fill their last
+ *        K-frame, a partial one costs the same credit and radio event.
+ */
+static uint16_t L2capOffload_SDU_Size(const l2cap_offload_link_t *link)
+{
+    uint16_t sdu = (link->peer_mtu < APP_LECB_SDU_MAX) ? link->peer_mtu : APP_LECB_SDU_MAX;
+    uint16_t frames = (sdu + 2) / link->peer_mps;
+
+    if (frames > 1)
+    {
+        sdu = (frames * link->peer_mps) - 2;
+    }
+
+    return sdu;
+}
+
+/**
+ * @brief Return a credit to the peer for a request it sent
+ */
+static void L2capOffload_Give_Credit(uint8_t conidx)
+{
+    struct gapc_lecb_add_cmd *cmd;
+
+    cmd = KE_MSG_ALLOC(GAPC_LECB_ADD_CMD, KE_BUILD_ID(TASK_GAPC, conidx),
+                       TASK_APP, gapc_lecb_add_cmd);
+    cmd->operation = GAPC_LE_CB_ADDITION;
+    cmd->le_psm = L2CAP_OFFLOAD_PSM;
+    cmd->credit = 1;
+    ke_msg_send(cmd);
+}
+
+/**
+ * @brief Send SDUs while the heap budget and the peer credits allow it
+ */
+static void L2capOffload_Pump(uint8_t conidx)
+{
+    l2cap_offload_link_t *link = &l2cap_link[conidx];
+    l2cap_offload_source_t source = l2cap_source ? l2cap_source : L2capOffload_Pattern;
+    uint16_t max_data = L2capOffload_SDU_Size(link) - L2CAP_OFFLOAD_HDR_LEN;
+
+    while (link->running && (link->in_flight < APP_LECB_SDU_IN_FLIGHT))
+    {
+        uint16_t frames = L2capOffload_Frames(link, max_data + L2CAP_OFFLOAD_HDR_LEN);
+
+        if (link->peer_credits < frames)
+        {
+            /* Resumed on GAPC_LECB_ADD_IND */
+            l2cap_stats.credit_stalls++;
+            break;
+        }
+
+        struct l2cc_lecb_sdu_send_cmd *cmd = KE_MSG_ALLOC_DYN(L2CC_LECB_SDU_SEND_CMD,
+                                                              KE_BUILD_ID(TASK_L2CC, conidx),
+                                                              TASK_APP, l2cc_lecb_sdu_send_cmd,
+                                                              max_data + L2CAP_OFFLOAD_HDR_LEN);
+        uint16_t len = source(link->offset, &cmd->sdu.data[L2CAP_OFFLOAD_HDR_LEN], max_data);
+
+        if (len == 0)
+        {
+            /* End of the records */
+            ke_msg_free(ke_param2msg(cmd));
+            link->running = false;
+            ConnPolicy_Set_Bulk(conidx, false);
+            PhyMgr_Set_Bulk(conidx, false);
+            APP_LOG_INFO("__L2CAP offload %d done at offset %lu\r\n", conidx, link->offset);
+            break;
+        }
+
+        co_write32p(cmd->sdu.data, link->offset);
+        cmd->operation = L2CC_LECB_SDU_SEND;
+        cmd->offset = 0;
+        cmd->sdu.cid = link->cid;
+        cmd->sdu.credit = 0;
+        cmd->sdu.length = len + L2CAP_OFFLOAD_HDR_LEN;
+        cmd->sdu.offset = 0;
+        ke_msg_send(cmd);
+
+        frames = L2capOffload_Frames(link, len + L2CAP_OFFLOAD_HDR_LEN);
+        link->peer_credits -= frames;
+        link->offset += len;
+        link->sdu_end[(link->sdu_head + link->in_flight) % APP_LECB_SDU_IN_FLIGHT] = link->offset;
+        link->in_flight++;
+
+        l2cap_stats.sdus++;
+        l2cap_stats.frames += frames;
+        l2cap_stats.bytes += len;
+        PhyMgr_Add_Bytes(conidx, len + L2CAP_OFFLOAD_HDR_LEN);
+    }
+}
+
+/**
+ * @brief Handle a request SDU from the peer
+ */
+static void L2capOffload_Request(uint8_t conidx, const uint8_t *data, uint16_t length)
+{
+    l2cap_offload_link_t *link = &l2cap_link[conidx];
+
+    L2capOffload_Give_Credit(conidx);
+
+    if ((length >= 1 + L2CAP_OFFLOAD_HDR_LEN) && (data[0] == L2CAP_OFFLOAD_OP_START))
+    {
+        uint32_t offset = co_read32p(&data[1]);
+
+        /* SDUs in flight carry the offsets of the current upload */
+        if (link->running)
+        {
+            l2cap_stats.rejected++;
+            return;
+        }
+
+        link->offset = (offset == L2CAP_OFFLOAD_RESUME) ? link->resume_offset : offset;
+        if (link->offset != 0)
+        {
+            l2cap_stats.resumes++;
+        }
+
+        /* Short connection interval, 2M PHY and long LL PDUs for the
+         * upload */
+        struct gapc_set_le_pkt_size_cmd *cmd = KE_MSG_ALLOC(GAPC_SET_LE_PKT_SIZE_CMD,
+                                                            KE_BUILD_ID(TASK_GAPC, conidx),
+                                                            TASK_APP, gapc_set_le_pkt_size_cmd);
+        cmd->operation = GAPC_SET_LE_PKT_SIZE;
+        cmd->tx_octets = APP_STREAM_TX_OCTETS;
+        cmd->tx_time = APP_STREAM_TX_TIME;
+        ke_msg_send(cmd);
+
+        ConnPolicy_Set_Bulk(conidx, true);
+        PhyMgr_Set_Bulk(conidx, true);
+
+        link->running = true;
+        L2capOffload_Pump(conidx);
+    }
+    else if ((length >= 1) && (data[0] == L2CAP_OFFLOAD_OP_STOP) && link->running)
+    {
+        link->running = false;
+        ConnPolicy_Set_Bulk(conidx, false);
+        PhyMgr_Set_Bulk(conidx, false);
+    }
+}
+
+void L2capOffload_Init(void)
+{
+    struct gapm_lepsm_register_cmd *cmd;
+
+    memset(l2cap_link, 0, sizeof(l2cap_link));
+
+    cmd = KE_MSG_ALLOC(GAPM_LEPSM_REGISTER_CMD, TASK_GAPM, TASK_APP,
+                       gapm_lepsm_register_cmd);
+    cmd->operation = GAPM_LEPSM_REG;
+    cmd->le_psm = L2CAP_OFFLOAD_PSM;
+    cmd->app_task = TASK_APP;
+    cmd->sec_lvl = 0;
+    ke_msg_send(cmd);
+}
+
+void L2capOffload_SetSource(l2cap_offload_source_t source)
+{
+    l2cap_source = source;
+}
+
+void L2capOffload_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                             ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    uint8_t conidx = KE_IDX_GET(src_id);
+
+    if (conidx >= BLE_CONNECTION_MAX)
+    {
+        return;
+    }
+
+    l2cap_offload_link_t *link = &l2cap_link[conidx];
+
+    switch (msg_id)
+    {
+        case GAPC_LECB_CONNECT_REQ_IND:
+        {
+            const struct gapc_lecb_connect_req_ind *p = param;
+            struct gapc_lecb_connect_cfm *cfm;
+
+            if (p->le_psm != L2CAP_OFFLOAD_PSM)
+            {
+                break;
+            }
+
+            /* One channel per link */
+            cfm = KE_MSG_ALLOC(GAPC_LECB_CONNECT_CFM, src_id, TASK_APP,
+                               gapc_lecb_connect_cfm);
+            cfm->le_psm = p->le_psm;
+            cfm->local_cid = 0;
+            cfm->local_credit = L2CAP_OFFLOAD_RX_CREDITS;
+            cfm->local_mtu = APP_LECB_SDU_MAX;
+            cfm->local_mps = APP_LECB_MPS;
+            cfm->status = link->connected ? L2C_CB_CON_NO_RES_AVAIL : L2C_CB_CON_SUCCESS;
+            ke_msg_send(cfm);
+
+            if (!link->connected)
+            {
+                link->peer_mtu = p->peer_mtu;
+                link->peer_mps = p->peer_mps;
+            }
+        }
+        break;
+
+        case GAPC_LECB_CONNECT_IND:
+        {
+            const struct gapc_lecb_connect_ind *p = param;
+
+            if ((p->le_psm != L2CAP_OFFLOAD_PSM) || (p->status != GAP_ERR_NO_ERROR))
+            {
+                break;
+            }
+
+            link->connected = true;
+            link->running = false;
+            link->cid = p->local_cid;
+            link->peer_credits = p->peer_credit;
+            link->in_flight = 0;
+            link->sdu_head = 0;
+            l2cap_stats.channels++;
+        }
+        break;
+
+        case GAPC_LECB_ADD_IND:
+        {
+            const struct gapc_lecb_add_ind *p = param;
+
+            if (link->connected && (p->le_psm == L2CAP_OFFLOAD_PSM))
+            {
+                /* Credits added by the peer */
+                link->peer_credits += p->peer_credit;
+                L2capOffload_Pump(conidx);
+            }
+        }
+        break;
+
+        case L2CC_LECB_SDU_RECV_IND:
+        {
+            const struct l2cc_lecb_sdu_recv_ind *p = param;
+
+            if (link->connected && (p->sdu.cid == link->cid) && (p->status == GAP_ERR_NO_ERROR))
+            {
+                L2capOffload_Request(conidx, p->sdu.data, p->sdu.length);
+            }
+        }
+        break;
+
+        case L2CC_CMP_EVT:
+        {
+            const struct l2cc_cmp_evt *p = param;
+
+            if (!link->connected || (p->cid != link->cid) || (link->in_flight == 0))
+            {
+                break;
+            }
+
+            /* Data up to the end of the oldest SDU was sent, a new upload
+             * can resume from there */
+            if (p->status == GAP_ERR_NO_ERROR)
+            {
+                link->resume_offset = link->sdu_end[link->sdu_head];
+            }
+
+            link->sdu_head = (link->sdu_head + 1) % APP_LECB_SDU_IN_FLIGHT;
+            link->in_flight--;
+
+            L2capOffload_Pump(conidx);
+        }
+        break;
+
+        case GAPC_LECB_DISCONNECT_IND:
+        case GAPC_DISCONNECT_IND:
+        {
+            uint32_t resume_offset = link->resume_offset;
+
+            if (link->running)
+            {
+                ConnPolicy_Set_Bulk(conidx, false);
+                PhyMgr_Set_Bulk(conidx, false);
+            }
+            memset(link, 0, sizeof(*link));
+
+            /* A new channel on the same link can resume the upload */
+            if (msg_id == GAPC_LECB_DISCONNECT_IND)
+            {
+                link->resume_offset = resume_offset;
+            }
+        }
+        break;
+    }
+}
+
+const l2cap_offload_stats_t * L2capOffload_Get_Stats(void)
+{
+    return &l2cap_stats;
+}
+
+void L2capOffload_Log_Stats(void)
+{
+    const l2cap_offload_stats_t *l = L2capOffload_Get_Stats();
+
+    TRACE_LOG("STAT l2cap channels=%lu sdus=%lu frames=%lu bytes=%lu stalls=%lu resumes=%lu rejected=%lu\r\n",
+              l->channels, l->sdus, l->frames, l->bytes, l->credit_stalls,
+              l->resumes, l->rejected);
+}
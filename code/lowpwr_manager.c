@@ -18,7 +18,11 @@
 
 sleep_mode_cfg app_sleep_mode_cfg;
 
-void SOC_Sleep(void)
+/**
+ * @brief Enter sleep mode
+ * @param[in] sleep_type SLEEP_CORE_RETENTION or SLEEP_NO_RETENTION
+ */
+void SOC_Sleep(uint8_t sleep_type)
 {
     /* Initialize sleep before entering sleep */
     Sys_PowerModes_Sleep_Init(&app_sleep_mode_cfg);
@@ -31,13 +35,21 @@ void SOC_Sleep(void)
 
 #if defined (CFG_REDUCED_DRAM)
 
-    /* Enable the required amount of DRAMs */
-    SYSCTRL_MEM_POWER_CFG->DRAM_POWER_BYTE = DRAM0_POWER_ENABLE_BYTE | DRAM1_POWER_ENABLE_BYTE |
-                                             DRAM2_POWER_ENABLE_BYTE | DRAM3_POWER_ENABLE_BYTE;
+    /* Only keep the DRAMs holding retained data powered, the mask is
+     * generated from the linker map by tools/dram_bank_mask.py */
+    SYSCTRL_MEM_POWER_CFG->DRAM_POWER_BYTE = DRAM_RETAINED_POWER_MASK;
 #endif    /* if defined (CFG_REDUCED_DRAM) */
 
-    /* Power Mode enter sleep with core retention */
-    Sys_PowerModes_Sleep_Enter(&app_sleep_mode_cfg, SLEEP_CORE_RETENTION);
+    PROFILER_MARK(PROFILER_POINT_SLEEP_ENTER);
+
+    /* Power Mode enter sleep with or without core retention */
+    Sys_PowerModes_Sleep_Enter(&app_sleep_mode_cfg, sleep_type);
+
+    /* UART is not retained, swmTrace is re-initialized on the next log */
+    Trace_Invalidate();
+
+    /* Wakeup restored SYSTEM_CLK from app_sleep_mode_cfg.clock_cfg */
+    Clock_Sleep_Exit();
 }
 
 /**
@@ -75,6 +87,8 @@ void RTC_Alarm_Wakeup_Process_Handler(void)
  */
 void WAKEUP_IRQHandler(void)
 {
+    PROFILER_MARK(PROFILER_POINT_WAKEUP);
+
     SYS_WATCHDOG_REFRESH();
 
     /* Check if GPIO1 wakeup event set */
@@ -95,6 +109,9 @@ void WAKEUP_IRQHandler(void)
     {
         /* Clear the BB Timer sticky flag */
         WAKEUP_BB_TIMER_FLAG_CLEAR();
+
+        /* Feed BLE wakeup timing to the sleep coordinator */
+        SleepCoord_BLE_Wakeup();
     }
 
     /* If there is an pending wakeup event set during the execution of this
@@ -0,0 +1,329 @@
+/**
+ * @file ntf_queue.c
+ * @brief Notification queue source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <string.h>
+
+/**
+ * @brief Queue entry, the payload stays in the pool message
+ */
+typedef struct
+{
+    uint16_t handle;
+    uint16_t length;
+    uint8_t operation;
+    uint8_t buf_idx;
+} ntf_queue_entry_t;
+
+/**
+ * @brief Per connection queue
+ */
+typedef struct
+{
+    ntf_queue_entry_t entry[NTF_QUEUE_DEPTH];
+    uint8_t head;
+    uint8_t count;
+    uint8_t in_flight;
+} ntf_queue_t;
+
+/* Stack messages allocated ahead, a NULL entry was handed to the stack and
+ * is allocated again once released */
+static struct gattc_send_evt_cmd *ntf_pool[NTF_QUEUE_POOL_SIZE];
+static uint8_t ntf_pool_ref[NTF_QUEUE_POOL_SIZE];
+static uint8_t ntf_pool_used;
+static ntf_queue_pool_stats_t ntf_pool_stats;
+
+static ntf_queue_t ntf_queue[APP_MAX_NB_CON];
+static ntf_queue_stats_t ntf_queue_stats[APP_MAX_NB_CON];
+
+/**
+ * @brief Allocate a GATTC_SEND_EVT_CMD message with room for a payload
+ */
+static struct gattc_send_evt_cmd * NtfQueue_MsgAlloc(void)
+{
+    return KE_MSG_ALLOC_DYN(GATTC_SEND_EVT_CMD, KE_BUILD_ID(TASK_GATTC, 0),
+                            TASK_APP, gattc_send_evt_cmd, NTF_QUEUE_BUF_SIZE);
+}
+
+/**
+ * @brief Drop one reference to a pool message, a message sent to the stack
+ *        is replaced once free
+ */
+static void NtfQueue_Release(uint8_t buf_idx)
+{
+    if (ntf_pool_ref[buf_idx] && (--ntf_pool_ref[buf_idx] == 0))
+    {
+        ntf_pool_used--;
+
+        if (ntf_pool[buf_idx] == NULL)
+        {
+            ntf_pool[buf_idx] = NtfQueue_MsgAlloc();
+        }
+    }
+}
+
+/**
+ * @brief Pool message holding a payload buffer
+ *
+ * @return Index in ntf_pool, NTF_QUEUE_POOL_SIZE if buf is not a payload
+ *         of an allocated pool message
+ */
+static uint8_t NtfQueue_Index(const uint8_t *buf)
+{
+    for (uint8_t i = 0; i < NTF_QUEUE_POOL_SIZE; i++)
+    {
+        if ((ntf_pool[i] != NULL) && (buf == ntf_pool[i]->value) && ntf_pool_ref[i])
+        {
+            return i;
+        }
+    }
+
+    return NTF_QUEUE_POOL_SIZE;
+}
+
+/**
+ * @brief Hand queued entries to the stack up to NTF_QUEUE_IN_FLIGHT. The
+ *        last queue holding a payload sends the pool message itself, the
+ *        other queues send a copy.
+ */
+static void NtfQueue_Drain(uint8_t conidx)
+{
+    ntf_queue_t *q = &ntf_queue[conidx];
+
+    while (q->count && (q->in_flight < NTF_QUEUE_IN_FLIGHT))
+    {
+        ntf_queue_entry_t *e = &q->entry[q->head];
+        struct gattc_send_evt_cmd *cmd;
+
+        if (ntf_pool_ref[e->buf_idx] == 1)
+        {
+            cmd = ntf_pool[e->buf_idx];
+            ntf_pool[e->buf_idx] = NULL;
+        }
+        else
+        {
+            cmd = NtfQueue_MsgAlloc();
+            memcpy(cmd->value, ntf_pool[e->buf_idx]->value, e->length);
+            ntf_pool_stats.copies++;
+        }
+
+        cmd->operation = e->operation;
+        cmd->seq_num = NTF_QUEUE_SEQ_NUM;
+        cmd->handle = e->handle;
+        cmd->length = e->length;
+        ke_param2msg(cmd)->dest_id = KE_BUILD_ID(TASK_GATTC, conidx);
+        ke_msg_send(cmd);
+
+        PhyMgr_Add_Bytes(conidx, e->length);
+        NtfQueue_Release(e->buf_idx);
+
+        q->head = (q->head + 1) % NTF_QUEUE_DEPTH;
+        q->count--;
+        q->in_flight++;
+    }
+}
+
+void NtfQueue_Init(void)
+{
+    memset(ntf_pool_ref, 0, sizeof(ntf_pool_ref));
+    memset(ntf_queue, 0, sizeof(ntf_queue));
+    memset(ntf_queue_stats, 0, sizeof(ntf_queue_stats));
+    memset(&ntf_pool_stats, 0, sizeof(ntf_pool_stats));
+    ntf_pool_used = 0;
+
+    /* Messages kept from a previous initialization are reused */
+    for (uint8_t i = 0; i < NTF_QUEUE_POOL_SIZE; i++)
+    {
+        if (ntf_pool[i] == NULL)
+        {
+            ntf_pool[i] = NtfQueue_MsgAlloc();
+        }
+    }
+
+    AppDispatch_Add_Op(GATTC_CMP_EVT, GATTC_NOTIFY, NtfQueue_MsgHandler);
+    AppDispatch_Add_Op(GATTC_CMP_EVT, GATTC_INDICATE, NtfQueue_MsgHandler);
+    AppDispatch_Add(GAPC_DISCONNECT_IND, NtfQueue_MsgHandler);
+}
+
+uint8_t * NtfQueue_Alloc(void)
+{
+    for (uint8_t i = 0; i < NTF_QUEUE_POOL_SIZE; i++)
+    {
+        if ((ntf_pool_ref[i] == 0) && (ntf_pool[i] != NULL))
+        {
+            /* Reference of the producer, passed on by NtfQueue_Send() */
+            ntf_pool_ref[i] = 1;
+            ntf_pool_used++;
+            ntf_pool_stats.allocs++;
+
+            if (ntf_pool_used > ntf_pool_stats.high_watermark)
+            {
+                ntf_pool_stats.high_watermark = ntf_pool_used;
+            }
+
+            return ntf_pool[i]->value;
+        }
+    }
+
+    ntf_pool_stats.exhausted++;
+    return NULL;
+}
+
+uint8_t NtfQueue_Send(uint8_t *buf, uint16_t length, uint16_t handle,
+                      uint8_t operation, uint32_t con_mask)
+{
+    uint8_t buf_idx = NtfQueue_Index(buf);
+    uint8_t nb = 0;
+
+    if (buf_idx == NTF_QUEUE_POOL_SIZE)
+    {
+        APP_LOG_ERROR("NtfQueue: buffer not allocated from the pool\r\n");
+        return 0;
+    }
+
+    if (length > NTF_QUEUE_BUF_SIZE)
+    {
+        length = NTF_QUEUE_BUF_SIZE;
+    }
+
+    for (uint8_t conidx = 0; conidx < APP_MAX_NB_CON; conidx++)
+    {
+        ntf_queue_t *q = &ntf_queue[conidx];
+
+        if (!(con_mask & NTF_QUEUE_CON(conidx)) || !GAPC_IsConnectionActive(conidx))
+        {
+            continue;
+        }
+
+        if (q->count == NTF_QUEUE_DEPTH)
+        {
+            ntf_queue_stats[conidx].drops++;
+            continue;
+        }
+
+        ntf_queue_entry_t *e = &q->entry[(q->head + q->count) % NTF_QUEUE_DEPTH];
+        e->handle = handle;
+        e->length = length;
+        e->operation = operation;
+        e->buf_idx = buf_idx;
+
+        ntf_pool_ref[buf_idx]++;
+        q->count++;
+        ntf_queue_stats[conidx].queued++;
+
+        if (q->count > ntf_queue_stats[conidx].high_watermark)
+        {
+            ntf_queue_stats[conidx].high_watermark = q->count;
+        }
+
+        nb++;
+    }
+
+    /* Queues hold their own references, drop the producer's one before
+     * draining so the buffer returns as soon as the last queue sent it */
+    NtfQueue_Release(buf_idx);
+
+    for (uint8_t conidx = 0; conidx < APP_MAX_NB_CON; conidx++)
+    {
+        if (con_mask & NTF_QUEUE_CON(conidx))
+        {
+            NtfQueue_Drain(conidx);
+        }
+    }
+
+    return nb;
+}
+
+void NtfQueue_Flush(uint8_t conidx)
+{
+    ntf_queue_t *q = &ntf_queue[conidx];
+
+    while (q->count)
+    {
+        NtfQueue_Release(q->entry[q->head].buf_idx);
+        q->head = (q->head + 1) % NTF_QUEUE_DEPTH;
+        q->count--;
+    }
+
+    /* Messages in flight are freed by the stack with the link */
+    q->in_flight = 0;
+}
+
+void NtfQueue_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                         ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    uint8_t conidx = KE_IDX_GET(src_id);
+
+    if (conidx >= APP_MAX_NB_CON)
+    {
+        return;
+    }
+
+    switch (msg_id)
+    {
+        case GATTC_CMP_EVT:
+        {
+            const struct gattc_cmp_evt *p = param;
+
+            if ((p->seq_num == NTF_QUEUE_SEQ_NUM) && ntf_queue[conidx].in_flight)
+            {
+                ntf_queue[conidx].in_flight--;
+                ntf_queue_stats[conidx].sent++;
+                NtfQueue_Drain(conidx);
+            }
+        }
+        break;
+
+        case GAPC_DISCONNECT_IND:
+        {
+            NtfQueue_Flush(conidx);
+        }
+        break;
+    }
+}
+
+const ntf_queue_stats_t * NtfQueue_Get_Stats(uint8_t conidx)
+{
+    return &ntf_queue_stats[conidx];
+}
+
+const ntf_queue_pool_stats_t * NtfQueue_Get_PoolStats(void)
+{
+    return &ntf_pool_stats;
+}
+
+void NtfQueue_Log_Stats(void)
+{
+    const ntf_queue_pool_stats_t *pool = NtfQueue_Get_PoolStats();
+
+    TRACE_LOG("STAT ntfpool allocs=%lu exhausted=%lu copies=%lu peak=%u/%u\r\n",
+              pool->allocs, pool->exhausted, pool->copies, pool->high_watermark,
+              NTF_QUEUE_POOL_SIZE);
+
+    for (uint8_t i = 0; i < APP_MAX_NB_CON; i++)
+    {
+        const ntf_queue_stats_t *q = NtfQueue_Get_Stats(i);
+
+        if (q->queued == 0)
+        {
+            continue;
+        }
+
+        TRACE_LOG("STAT ntfq %u queued=%lu sent=%lu drops=%lu peak=%u\r\n",
+                  i, q->queued, q->sent, q->drops, q->high_watermark);
+    }
+}
@@ -0,0 +1,249 @@
+/**
+ * @file phy_manager.c
+ * @brief PHY manager source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <string.h>
+
+/**
+ * @brief Per link state
+ */
+typedef struct
+{
+    bool active;
+    bool bulk;
+    bool coded;                             /**< Link quality calls for Coded PHY */
+    bool rssi_valid;
+    int16_t rssi;                           /**< Average RSSI (dBm) */
+    uint8_t phy;                            /**< Current transmit PHY */
+    uint8_t requested;                      /**< Last PHY requested */
+    uint64_t since;                         /**< PHY in use since (RTC cycles) */
+} phy_mgr_link_t;
+
+static phy_mgr_link_t phy_mgr_link[BLE_CONNECTION_MAX];
+static phy_mgr_stats_t phy_mgr_stats;
+
+/**
+ * @brief Account the time spent on the current PHY of a link
+ */
+static void PhyMgr_Account(phy_mgr_link_t *link)
+{
+    uint64_t now = RTC_Get_Timestamp();
+
+    if (link->active)
+    {
+        phy_mgr_stats.time[link->phy] += now - link->since;
+    }
+    link->since = now;
+}
+
+/**
+ * @brief Request the PHY the link should use
+ */
+static void PhyMgr_Update(uint8_t conidx)
+{
+    phy_mgr_link_t *link = &phy_mgr_link[conidx];
+    struct gapc_set_phy_cmd *cmd;
+    uint8_t target;
+
+    /* 2M needs a good link, a weak link stays on Coded even for bulk */
+    if (link->coded)
+    {
+        target = PHY_MGR_CODED;
+    }
+    else
+    {
+        target = link->bulk ? PHY_MGR_2M : PHY_MGR_1M;
+    }
+
+    if (target == link->requested)
+    {
+        return;
+    }
+
+    cmd = KE_MSG_ALLOC(GAPC_SET_PHY_CMD, KE_BUILD_ID(TASK_GAPC, conidx),
+                       TASK_APP, gapc_set_phy_cmd);
+    cmd->operation = GAPC_SET_PHY;
+    cmd->tx_phy = (target == PHY_MGR_CODED) ? GAP_PHY_LE_CODED :
+                  (target == PHY_MGR_2M) ? GAP_PHY_LE_2MBPS : GAP_PHY_LE_1MBPS;
+    cmd->rx_phy = cmd->tx_phy;
+    cmd->phy_opt = GAPC_PHY_OPT_LE_CODED_125K_RATE;
+    ke_msg_send(cmd);
+
+    link->requested = target;
+    phy_mgr_stats.requests++;
+}
+
+/**
+ * @brief Ask the stack for the RSSI of a link
+ */
+static void PhyMgr_Get_RSSI(uint8_t conidx)
+{
+    struct gapc_get_info_cmd *cmd;
+
+    cmd = KE_MSG_ALLOC(GAPC_GET_INFO_CMD, KE_BUILD_ID(TASK_GAPC, conidx),
+                       TASK_APP, gapc_get_info_cmd);
+    cmd->operation = GAPC_GET_CON_RSSI;
+    ke_msg_send(cmd);
+    phy_mgr_stats.rssi_polls++;
+
+    ke_timer_set(PHY_MGR_RSSI_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx),
+                 TIMER_SETTING_MS(PHY_MGR_RSSI_PERIOD_MS));
+}
+
+void PhyMgr_Set_Bulk(uint8_t conidx, bool bulk)
+{
+    if ((conidx >= BLE_CONNECTION_MAX) || !phy_mgr_link[conidx].active)
+    {
+        return;
+    }
+
+    if (bulk == phy_mgr_link[conidx].bulk)
+    {
+        return;
+    }
+
+    phy_mgr_link[conidx].bulk = bulk;
+    PhyMgr_Update(conidx);
+
+    /* The PHY only matters while data flows, idle links are not polled */
+    if (bulk)
+    {
+        PhyMgr_Get_RSSI(conidx);
+    }
+    else
+    {
+        ke_timer_clear(PHY_MGR_RSSI_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx));
+    }
+}
+
+void PhyMgr_Add_Bytes(uint8_t conidx, uint16_t length)
+{
+    if (conidx < BLE_CONNECTION_MAX)
+    {
+        phy_mgr_stats.bytes[phy_mgr_link[conidx].phy] += length;
+    }
+}
+
+void PhyMgr_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                       ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    switch (msg_id)
+    {
+        case GAPC_CONNECTION_REQ_IND:
+        {
+            uint8_t conidx = KE_IDX_GET(src_id);
+            phy_mgr_link_t *link = &phy_mgr_link[conidx];
+
+            /* Connections start on 1M, the PHY the connectable advertising
+             * uses */
+            memset(link, 0, sizeof(*link));
+            link->phy = PHY_MGR_1M;
+            link->requested = PHY_MGR_1M;
+            link->since = RTC_Get_Timestamp();
+            link->active = true;
+        }
+        break;
+
+        case GAPC_LE_PHY_IND:
+        {
+            const struct gapc_le_phy_ind *p = param;
+            phy_mgr_link_t *link = &phy_mgr_link[KE_IDX_GET(src_id)];
+
+            PhyMgr_Account(link);
+            link->phy = (p->tx_phy == GAP_PHY_2MBPS) ? PHY_MGR_2M :
+                        (p->tx_phy == GAP_PHY_1MBPS) ? PHY_MGR_1M : PHY_MGR_CODED;
+
+            /* The peer may refuse or pick another PHY */
+            link->requested = link->phy;
+            phy_mgr_stats.changes++;
+        }
+        break;
+
+        case GAPC_CON_RSSI_IND:
+        {
+            const struct gapc_con_rssi_ind *p = param;
+            uint8_t conidx = KE_IDX_GET(src_id);
+            phy_mgr_link_t *link = &phy_mgr_link[conidx];
+
+            if (!link->rssi_valid)
+            {
+                link->rssi = p->rssi;
+                link->rssi_valid = true;
+            }
+            else
+            {
+                link->rssi += (p->rssi - link->rssi) / (1 << PHY_MGR_RSSI_SHIFT);
+            }
+
+            /* Hysteresis keeps a link at the edge from switching back and forth */
+            if (!link->coded && (link->rssi < PHY_MGR_CODED_ENTER_RSSI))
+            {
+                link->coded = true;
+                PhyMgr_Update(conidx);
+            }
+            else if (link->coded && (link->rssi > PHY_MGR_CODED_EXIT_RSSI))
+            {
+                link->coded = false;
+                PhyMgr_Update(conidx);
+            }
+        }
+        break;
+
+        case PHY_MGR_RSSI_TIMEOUT:
+        {
+            uint8_t conidx = KE_IDX_GET(dest_id);
+
+            if (phy_mgr_link[conidx].active && phy_mgr_link[conidx].bulk)
+            {
+                PhyMgr_Get_RSSI(conidx);
+            }
+        }
+        break;
+
+        case GAPC_DISCONNECT_IND:
+        {
+            uint8_t conidx = KE_IDX_GET(src_id);
+
+            PhyMgr_Account(&phy_mgr_link[conidx]);
+            phy_mgr_link[conidx].active = false;
+            ke_timer_clear(PHY_MGR_RSSI_TIMEOUT, KE_BUILD_ID(TASK_APP, conidx));
+        }
+        break;
+    }
+}
+
+const phy_mgr_stats_t * PhyMgr_Get_Stats(void)
+{
+    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        PhyMgr_Account(&phy_mgr_link[i]);
+    }
+
+    return &phy_mgr_stats;
+}
+
+void PhyMgr_Log_Stats(void)
+{
+    const phy_mgr_stats_t *p = PhyMgr_Get_Stats();
+
+    TRACE_LOG("STAT phy requests=%lu changes=%lu polls=%lu\r\n",
+              p->requests, p->changes, p->rssi_polls);
+    TRACE_LOG("STAT phy ms 1M=%lu 2M=%lu coded=%lu bytes 1M=%lu 2M=%lu coded=%lu\r\n",
+              STATS_REPORT_MS(p->time[PHY_MGR_1M]), STATS_REPORT_MS(p->time[PHY_MGR_2M]),
+              STATS_REPORT_MS(p->time[PHY_MGR_CODED]), p->bytes[PHY_MGR_1M],
+              p->bytes[PHY_MGR_2M], p->bytes[PHY_MGR_CODED]);
+}
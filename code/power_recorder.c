@@ -0,0 +1,148 @@
+/**
+ * @file power_recorder.c
+ * @brief Power state recorder source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  DIAG
+
+#include "app.h"
+#include <string.h>
+
+/* Entries logged per call, fits in the swmTrace non-blocking buffer */
+#define POWER_REC_DUMP_BURST            4
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t seq;                                   /**< Sequence number of next entry */
+    uint16_t count;                                 /**< Valid entries, up to POWER_REC_SIZE */
+    power_rec_entry_t entry[POWER_REC_SIZE];
+} power_rec_t;
+
+/* Kept across sleep and warm resets */
+static power_rec_t power_rec __attribute__ ((section(".noinit")));
+
+static uint16_t power_rec_dump_seq;                 /**< Sequence number of the next entry to dump */
+static uint16_t power_rec_dump_left = 0;            /**< Entries left in the dump in progress */
+
+void PowerRec_Init(void)
+{
+    if (power_rec.magic != POWER_REC_MAGIC)
+    {
+        memset(&power_rec, 0, sizeof(power_rec));
+        power_rec.magic = POWER_REC_MAGIC;
+    }
+
+    PowerRec_Record(POWER_REC_RUN, POWER_REC_CAUSE_RESET);
+}
+
+void PowerRec_Record(power_rec_state_t state, uint8_t cause)
+{
+    GLOBAL_INT_DISABLE();
+
+    power_rec_entry_t *e = &power_rec.entry[power_rec.seq & (POWER_REC_SIZE - 1)];
+
+    e->timestamp = (uint32_t)RTC_Get_Timestamp();
+    e->state = state;
+    e->cause = cause;
+    e->seq = power_rec.seq++;
+
+    if (power_rec.count < POWER_REC_SIZE)
+    {
+        power_rec.count++;
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+uint8_t PowerRec_Wakeup_Cause(void)
+{
+    uint32_t events = ACS->WAKEUP_CTRL;
+    uint8_t cause = POWER_REC_CAUSE_NONE;
+
+    if (events & WAKEUP_RTC_ALARM_EVENT_SET)
+    {
+        cause |= POWER_REC_CAUSE_RTC;
+    }
+
+    if (events & WAKEUP_BB_TIMER_EVENT_SET)
+    {
+        cause |= POWER_REC_CAUSE_BB_TIMER;
+    }
+
+    if (events & WAKEUP_GPIO1_EVENT_SET)
+    {
+        cause |= POWER_REC_CAUSE_GPIO1;
+    }
+
+    return (cause != POWER_REC_CAUSE_NONE) ? cause : POWER_REC_CAUSE_IRQ;
+}
+
+void PowerRec_Dump(void)
+{
+    GLOBAL_INT_DISABLE();
+
+    uint16_t count = power_rec.count;
+    uint16_t seq = power_rec.seq;
+    uint32_t now = (uint32_t)RTC_Get_Timestamp();
+
+    GLOBAL_INT_RESTORE();
+
+    /* Header: current timestamp, sequence number of next entry and number
+     * of entries that follow, oldest first */
+    APP_LOG_INFO("PWRREC H %08lx %04x %u\r\n", now, seq, count);
+
+    power_rec_dump_seq = seq - count;
+    power_rec_dump_left = count;
+
+    PowerRec_Dump_Continue();
+}
+
+void PowerRec_Dump_Continue(void)
+{
+    for (uint8_t i = 0; (i < POWER_REC_DUMP_BURST) && power_rec_dump_left; i++)
+    {
+        power_rec_entry_t e = power_rec.entry[power_rec_dump_seq & (POWER_REC_SIZE - 1)];
+
+        /* Overwritten since the header, the analyzer skips incomplete dumps */
+        if (e.seq != power_rec_dump_seq)
+        {
+            power_rec_dump_left = 0;
+            break;
+        }
+
+        APP_LOG_INFO("PWRREC E %08lx %u %02x %04x\r\n", e.timestamp, e.state, e.cause, e.seq);
+
+        power_rec_dump_seq++;
+        power_rec_dump_left--;
+    }
+}
+
+void PowerRec_Dump_Periodic(void)
+{
+#if POWER_REC_LOG_PERIOD
+    static uint16_t power_rec_log_count = 0;
+
+    if (power_rec_dump_left)
+    {
+        PowerRec_Dump_Continue();
+    }
+    else if (++power_rec_log_count >= POWER_REC_LOG_PERIOD)
+    {
+        power_rec_log_count = 0;
+        PowerRec_Dump();
+    }
+#endif    /* if POWER_REC_LOG_PERIOD */
+}
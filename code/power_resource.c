@@ -0,0 +1,235 @@
+/**
+ * @file power_resource.c
+ * @brief Peripheral power resource manager source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+
+/* Domains managed at runtime, the others are pinned on */
+static const bool power_domain_managed[POWER_DOMAIN_NB] =
+{
+    [POWER_DOMAIN_SENSOR] = SENSOR_POWER_DISABLE,
+    [POWER_DOMAIN_CC312] = CC312AO_POWER_DISABLE,
+    [POWER_DOMAIN_FPU] = POWER_DOWN_FPU,
+    [POWER_DOMAIN_DBG] = POWER_DOWN_DBG,
+    [POWER_DOMAIN_VDDIF] = VDDIF_POWER_DOWN
+};
+
+static power_domain_stats_t power_domain[POWER_DOMAIN_NB];
+
+/**
+ * @brief Switch a domain on or off
+ * @return false if the domain refused to power down
+ */
+static bool PowerRes_Set(power_domain_t domain, bool on)
+{
+    bool done = true;
+
+    switch (domain)
+    {
+        case POWER_DOMAIN_SENSOR:
+        {
+            if (on)
+            {
+                Sys_Sensor_Enable();
+            }
+            else
+            {
+                Sys_Sensor_Disable();
+            }
+            break;
+        }
+
+        case POWER_DOMAIN_CC312:
+        {
+            if (on)
+            {
+                Sys_Power_CC312AO_Enable();
+            }
+            else
+            {
+                Sys_Power_CC312AO_Disable();
+            }
+            break;
+        }
+
+        case POWER_DOMAIN_FPU:
+        {
+            if (on)
+            {
+                Power_Up_FPU();
+            }
+            else
+            {
+                done = (Power_Down_FPU() == FPU_Q_ACCEPTED);
+            }
+            break;
+        }
+
+        case POWER_DOMAIN_DBG:
+        {
+            if (on)
+            {
+                Power_Up_Debug();
+            }
+            else
+            {
+                done = (Power_Down_Debug() == DBG_Q_ACCEPTED);
+            }
+            break;
+        }
+
+        case POWER_DOMAIN_VDDIF:
+        {
+            if (on)
+            {
+                ACS->VDDIF_CTRL |= VDDIF_ENABLE;
+            }
+            else
+            {
+                ACS->VDDIF_CTRL &= ~VDDIF_ENABLE;
+            }
+            break;
+        }
+
+        default:
+        {
+        }
+    }
+
+    return done;
+}
+
+/**
+ * @brief Power down a domain without users. A refused power down leaves it
+ *        on until its next release.
+ */
+static void PowerRes_Power_Down(power_domain_t domain)
+{
+    power_domain_stats_t *d = &power_domain[domain];
+
+    if (!d->on)
+    {
+        return;
+    }
+
+    if (PowerRes_Set(domain, false))
+    {
+        d->on = false;
+        d->on_cycles += RTC_Get_Timestamp() - d->on_since;
+    }
+    else
+    {
+        d->denied++;
+    }
+}
+
+void PowerRes_Init(void)
+{
+    for (uint8_t i = 0; i < POWER_DOMAIN_NB; i++)
+    {
+        power_domain[i].pinned = !power_domain_managed[i];
+        power_domain[i].users = 0;
+        power_domain[i].on = true;
+        power_domain[i].on_since = RTC_Get_Timestamp();
+
+        /* A debugger attached at boot holds the debug unit */
+        if ((i == POWER_DOMAIN_DBG) && (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+        {
+            power_domain[i].users = 1;
+        }
+
+        if (power_domain[i].pinned)
+        {
+            /* Only VDDIF is explicitly enabled by default, the other domains
+             * are on after reset */
+            if (i == POWER_DOMAIN_VDDIF)
+            {
+                PowerRes_Set(i, true);
+            }
+        }
+        else if (power_domain[i].users == 0)
+        {
+            PowerRes_Power_Down(i);
+        }
+    }
+}
+
+bool PowerRes_Acquire(power_domain_t domain)
+{
+    power_domain_stats_t *d = &power_domain[domain];
+
+    GLOBAL_INT_DISABLE();
+
+    if ((d->users++ == 0) && !d->on)
+    {
+        PowerRes_Set(domain, true);
+        d->on = true;
+        d->on_since = RTC_Get_Timestamp();
+        d->power_ups++;
+    }
+
+    GLOBAL_INT_RESTORE();
+
+    return PowerRes_Is_On(domain);
+}
+
+void PowerRes_Release(power_domain_t domain)
+{
+    power_domain_stats_t *d = &power_domain[domain];
+
+    GLOBAL_INT_DISABLE();
+
+    if (d->users && (--d->users == 0) && !d->pinned)
+    {
+        PowerRes_Power_Down(domain);
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+bool PowerRes_Is_On(power_domain_t domain)
+{
+    return power_domain[domain].on;
+}
+
+uint64_t PowerRes_Get_OnTime(power_domain_t domain)
+{
+    const power_domain_stats_t *d = &power_domain[domain];
+
+    if (PowerRes_Is_On(domain))
+    {
+        return d->on_cycles + (RTC_Get_Timestamp() - d->on_since);
+    }
+
+    return d->on_cycles;
+}
+
+const power_domain_stats_t * PowerRes_Get_Stats(power_domain_t domain)
+{
+    return &power_domain[domain];
+}
+
+void PowerRes_Log_Stats(void)
+{
+    for (uint8_t i = 0; i < POWER_DOMAIN_NB; i++)
+    {
+        const power_domain_stats_t *d = PowerRes_Get_Stats(i);
+
+        TRACE_LOG("STAT pwr %u users=%u on=%u ups=%lu denied=%lu on_ms=%lu\r\n",
+                  i, d->users, d->on, d->power_ups, d->denied,
+                  STATS_REPORT_MS(PowerRes_Get_OnTime(i)));
+    }
+}
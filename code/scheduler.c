@@ -14,6 +14,8 @@
  * This is Reusable Code.
  * @endparblock
  */
+#define APP_LOG_MODULE                  SCHEDULER
+
 #include "scheduler.h"
 
 static scheduler_task scheduler_task_queue[SCHEDULER_TASK_MAX];     /**< Task queue. */
@@ -49,6 +51,7 @@ Task_Creation_t Scheduler_Create_NewTask(p_schedular_task_t task, uint32_t arriv
         scheduler_task_queue[total_scheduled_tasks].arrival_cycles = arrival_cycles;
         scheduler_task_queue[total_scheduled_tasks].task_state = TASK_BLOCKED;
         scheduler_task_queue[total_scheduled_tasks].count_cycles = 0;
+        scheduler_task_queue[total_scheduled_tasks].clock_level = CLOCK_LEVEL_LOW;
         total_scheduled_tasks++;
     }
 
@@ -73,10 +76,19 @@ void Scheduler_Update_CountCycle(uint32_t wakeup_cycle_count)
         /* Ignore SUSPENDED tasks. */
         if (TASK_SUSPENDED != scheduler_task_queue[i].task_state)
         {
-            /* Put it into READY state. */
-            if (scheduler_task_queue[i].arrival_cycles <= scheduler_task_queue[i].count_cycles)
+            /* Put it into READY state. Tasks due shortly after this wakeup
+             * are run now instead of requiring one more wakeup. */
+            if ((int64_t)scheduler_task_queue[i].arrival_cycles <=
+                ((int64_t)scheduler_task_queue[i].count_cycles + SCHEDULER_COALESCE_CYCLES))
             {
-                scheduler_task_queue[i].count_cycles = 0;
+                /* Advance by whole periods from the original deadline, a
+                 * task run early keeps a negative count and its next
+                 * deadline stays on the same grid */
+                do
+                {
+                    scheduler_task_queue[i].count_cycles -= (int32_t)scheduler_task_queue[i].arrival_cycles;
+                } while (scheduler_task_queue[i].count_cycles >= (int32_t)scheduler_task_queue[i].arrival_cycles);
+
                 scheduler_task_queue[i].task_state  = TASK_READY;
             }
         }
@@ -92,7 +104,11 @@ void Scheduler_Run_ReadyTask(void)
         {
             if(scheduler_task_queue[i].task_function)
             {
+                Clock_Request(CLOCK_USER_TASK, scheduler_task_queue[i].clock_level);
+                PROFILER_MARK(PROFILER_POINT_TASK_START);
             	scheduler_task_queue[i].task_function();
+                PROFILER_MARK(PROFILER_POINT_TASK_END);
+                Clock_Request(CLOCK_USER_TASK, CLOCK_LEVEL_LOW);
             }
             scheduler_task_queue[i].task_state = TASK_BLOCKED;
         }
@@ -109,7 +125,8 @@ uint64_t Scheduler_Calculate_SleepDuration(void)
     {
         if (TASK_BLOCKED == scheduler_task_queue[i].task_state)
         {
-            task_wakeup_time = scheduler_task_queue[i].arrival_cycles - scheduler_task_queue[i].count_cycles;
+            task_wakeup_time = (uint64_t)((int64_t)scheduler_task_queue[i].arrival_cycles -
+                                          scheduler_task_queue[i].count_cycles);
 
             if (task_wakeup_time <= next_wakeup_time)
             {
@@ -126,16 +143,34 @@ void Scheduler_Set_ArrivalCycle(uint8_t scheduled_task_number, uint32_t arrival_
     scheduler_task_queue[scheduled_task_number].arrival_cycles = arrival_cycle;
 }
 
+void Scheduler_Set_ClockLevel(uint8_t scheduled_task_number, clock_level_t clock_level)
+{
+    scheduler_task_queue[scheduled_task_number].clock_level = clock_level;
+}
+
 void Scheduler_Create_Tasks(void)
 {
     Scheduler_Create_NewTask(&Task0_BLEAdvControl, CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_S(BLE_ADV_ON_DURATION)));
     Scheduler_Create_NewTask(&Task1_Dummy, CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_S(TASK1_BURST_TIME_S)));
+
+#if (APP_BROADCAST_ENABLE == 1)
+    Scheduler_Create_NewTask(&Task2_Broadcast, CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_S(BROADCAST_PERIOD_S)));
+#endif    /* if (APP_BROADCAST_ENABLE == 1) */
+
+    /* Advertising control and record encoding run faster, the dummy task
+     * is pure bookkeeping and stays at CLOCK_LEVEL_LOW */
+    Scheduler_Set_ClockLevel(TASK_0, CLOCK_LEVEL_16MHZ);
+#if (APP_BROADCAST_ENABLE == 1)
+    Scheduler_Set_ClockLevel(TASK_2, CLOCK_LEVEL_24MHZ);
+#endif    /* if (APP_BROADCAST_ENABLE == 1) */
 }
 
 void Scheduler_Main(void)
 {
     static uint8_t startup_flag = 1;
 
+    PROFILER_MARK(PROFILER_POINT_SCHED_START);
+
     /* Check startup once to setup initial count cycles for each
      * scheduled tasks */
     if (startup_flag)
@@ -156,16 +191,14 @@ void Scheduler_Main(void)
     /* Calculate sleep time for next task need to execute  */
     calc_sleep_duration = Scheduler_Calculate_SleepDuration();
 
-#if DEBUG_SCHEDULER
-    swmLogInfo("Calculated sleep duration = %d millisec\n\r", (uint32_t)(calc_sleep_duration / 32.768));
-    Sys_Delay(0.025 * SystemCoreClock);
-#endif    /* if DEBUG_SCHEDULER */
+    /* Move the deadline onto the next BLE wakeup when it is close enough */
+    calc_sleep_duration = SleepCoord_Plan(calc_sleep_duration);
+
+    APP_LOG_DEBUG("Calculated sleep duration = %d millisec\n\r", (uint32_t)((uint64_t)calc_sleep_duration * 1000 / 32768));
 
     /* Re-configure RTC wakeup time before entering sleep */
     prog_sleep_duration = RTC_ALARM_Reconfig(calc_sleep_duration, pre_sleep_duration, true);
+    PROFILER_MARK(PROFILER_POINT_RTC_RECONFIG);
 
-#if DEBUG_SCHEDULER
-    swmLogInfo("Programmed sleep duration = %d millisec\n\r", (uint32_t)(prog_sleep_duration / 32.768));
-    Sys_Delay(0.025 * SystemCoreClock);
-#endif    /* if DEBUG_SCHEDULER */
+    APP_LOG_DEBUG("Programmed sleep duration = %d millisec\n\r", (uint32_t)((uint64_t)prog_sleep_duration * 1000 / 32768));
 }
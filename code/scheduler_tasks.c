@@ -26,22 +26,24 @@ void Task0_BLEAdvControl(void)
     /* flag to control BLE advertisement */
     static bool enable_ble_adv = false;
 
-    /* Enable or disable BLE advertisement */
-    ControlBLEAdvActivity(enable_ble_adv);
+    /* Advertising windows opened, scanners can tell missed windows apart */
+    static uint16_t adv_windows = 0;
 
     if (enable_ble_adv)
     {
-        /* Update arrival cycle for Task 0 to wake up system at BLE_ADV_ON_DURATION next time */
-        Scheduler_Set_ArrivalCycle(TASK_0, CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_S(BLE_ADV_ON_DURATION)));
-        enable_ble_adv = false;
-    }
-    else
-    {
-        /* Update arrival cycle for Task 0 to wake up system at BLE_ADV_OFF_DURATION next time */
-        Scheduler_Set_ArrivalCycle(TASK_0, CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_S(BLE_ADV_OFF_DURATION)));
-        enable_ble_adv = true;
+        AdvData_Set_Slot(ADV_DATA_SLOT_COUNTER, ++adv_windows);
     }
 
+    /* Battery level used by the advertising policy and advertised */
+    APP_BASS_MeasureBatteryLevel();
+
+    /* Enable or disable BLE advertisement, the advertising policy selects
+     * the window length or off time until the next run of Task 0, in RTC
+     * cycles of 1/32768 s */
+    uint16_t next_s = AdvPolicy_Window(enable_ble_adv);
+    Scheduler_Set_ArrivalCycle(TASK_0, (uint32_t)next_s * 32768U);
+    enable_ble_adv = !enable_ble_adv;
+
 	/* Set TASK0 GPIO High at the end of Task execution */
 	Sys_GPIO_Set_High(TASK0_RUN_ACTIVITY_GPIO);
 }
@@ -57,12 +59,23 @@ void Task1_Dummy(void)
     Sys_GPIO_Set_High(TASK1_RUN_ACTIVITY_GPIO);
 }
 
-void Task2_Dummy(void)
+void Task2_Broadcast(void)
 {
 	/* Set TASK2 GPIO Low at the beginning of Task execution */
     Sys_GPIO_Set_Low(TASK2_RUN_ACTIVITY_GPIO);
 
-    /* Perform Task here */
+    /* Add a sensor record and broadcast the latest records, no connection
+     * is needed to read them. The battery is sampled for each record. */
+    static uint16_t seq = 0;
+    broadcast_record_t rec =
+    {
+        .seq = seq++,
+        .time_s = (uint32_t)(RTC_Get_Timestamp() / 32768),
+        .battery = APP_BASS_MeasureBatteryLevel()
+    };
+
+    Broadcast_Add_Record(&rec);
+    Broadcast_Update();
 
 	/* Set TASK2 GPIO High at the end of Task execution */
     Sys_GPIO_Set_High(TASK2_RUN_ACTIVITY_GPIO);
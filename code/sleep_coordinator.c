@@ -0,0 +1,124 @@
+/**
+ * @file sleep_coordinator.c
+ * @brief Sleep coordinator source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+
+static uint64_t ble_last_wakeup = 0;        /**< Timestamp of last BB timer wakeup (RTC cycles) */
+static uint32_t ble_wakeup_period = 0;      /**< Measured period between BB timer wakeups (RTC cycles) */
+static sleep_coord_stats_t sleep_coord_stats;
+
+void SleepCoord_Prepare(struct ble_sleep_api_param_tag *param)
+{
+    uint32_t remaining = RTC_ALARM_Get_RemainingCycles();
+    uint64_t half_slots = MAX_SLEEP_DURATION;
+
+    /* Wake the baseband up together with the scheduler, slightly ahead of
+     * the RTC alarm, instead of sleeping over it and waking twice */
+    if (remaining > SLEEP_COORD_GUARD_CYCLES)
+    {
+        half_slots = RTC_CYCLES_TO_HALF_SLOTS(remaining - SLEEP_COORD_GUARD_CYCLES);
+    }
+    else if (remaining)
+    {
+        half_slots = 0;
+    }
+
+    if (half_slots < MAX_SLEEP_DURATION)
+    {
+        param->max_sleep_duration = (uint32_t)half_slots;
+        sleep_coord_stats.ble_sleep_limited++;
+    }
+    else
+    {
+        param->max_sleep_duration = MAX_SLEEP_DURATION;
+    }
+}
+
+void SleepCoord_BLE_Wakeup(void)
+{
+    uint64_t now = RTC_Get_Timestamp();
+    uint64_t period = now - ble_last_wakeup;
+
+    /* Only keep periods that look like connection or advertising events,
+     * anything else (first wakeup, missed events) restarts the estimate */
+    if ((ble_last_wakeup != 0) &&
+        (period >= SLEEP_COORD_BLE_PERIOD_MIN_CYCLES) &&
+        (period <= SLEEP_COORD_BLE_PERIOD_MAX_CYCLES))
+    {
+        ble_wakeup_period = (uint32_t)period;
+    }
+    else
+    {
+        ble_wakeup_period = 0;
+    }
+
+    ble_last_wakeup = now;
+    sleep_coord_stats.ble_wakeups++;
+}
+
+uint32_t SleepCoord_Get_BLENextEvent(void)
+{
+    if ((ble_wakeup_period == 0) || (GAPC_ConnectionCount() == 0 && !ble_adv_enable))
+    {
+        return SLEEP_COORD_NO_BLE_EVENT;
+    }
+
+    uint64_t now = RTC_Get_Timestamp();
+    uint64_t since_last = now - ble_last_wakeup;
+
+    /* Estimate is stale if more than one period was missed */
+    if (since_last > (2 * (uint64_t)ble_wakeup_period))
+    {
+        return SLEEP_COORD_NO_BLE_EVENT;
+    }
+
+    return (uint32_t)(ble_wakeup_period - (since_last % ble_wakeup_period));
+}
+
+uint64_t SleepCoord_Plan(uint64_t sched_cycles)
+{
+    uint32_t ble_next = SleepCoord_Get_BLENextEvent();
+
+    if ((ble_next == SLEEP_COORD_NO_BLE_EVENT) || (ble_next < SLEEP_COORD_MIN_ALIGN_CYCLES))
+    {
+        return sched_cycles;
+    }
+
+    /* BLE wakes up shortly before the scheduler deadline; run the scheduler
+     * in the same wakeup. Tasks within SCHEDULER_COALESCE_CYCLES of their
+     * arrival are made READY by the scheduler. */
+    if ((ble_next < sched_cycles) && ((sched_cycles - ble_next) <= SLEEP_COORD_ALIGN_WINDOW_CYCLES))
+    {
+        sleep_coord_stats.aligned_deadlines++;
+        return ble_next;
+    }
+
+    return sched_cycles;
+}
+
+const sleep_coord_stats_t * SleepCoord_Get_Stats(void)
+{
+    return &sleep_coord_stats;
+}
+
+void SleepCoord_Log_Stats(void)
+{
+    const sleep_coord_stats_t *c = SleepCoord_Get_Stats();
+
+    TRACE_LOG("STAT sleepcoord ble_wakeups=%lu aligned=%lu limited=%lu\r\n",
+              c->ble_wakeups, c->aligned_deadlines, c->ble_sleep_limited);
+}
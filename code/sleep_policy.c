@@ -0,0 +1,216 @@
+/**
+ * @file sleep_policy.c
+ * @brief Sleep mode selection source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <string.h>
+
+static sleep_policy_cost_t sleep_policy_cost[SLEEP_POLICY_MODE_NB] =
+{
+    [SLEEP_POLICY_WFI] =
+    {
+        .energy_nj = SLEEP_POLICY_WFI_ENERGY,
+        .latency_us = SLEEP_POLICY_WFI_LATENCY,
+        .power_nw = SLEEP_POLICY_WFI_POWER
+    },
+    [SLEEP_POLICY_DEEP_RETENTION] =
+    {
+        .energy_nj = SLEEP_POLICY_RET_ENERGY,
+        .latency_us = SLEEP_POLICY_RET_LATENCY,
+        .power_nw = SLEEP_POLICY_RET_POWER
+    },
+    [SLEEP_POLICY_DEEP_NO_RETENTION] =
+    {
+        .energy_nj = SLEEP_POLICY_NORET_ENERGY,
+        .latency_us = SLEEP_POLICY_NORET_LATENCY,
+        .power_nw = SLEEP_POLICY_NORET_POWER
+    }
+};
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t no_ret_pending;                        /**< Sleep without retention entered, counted on the next boot */
+    sleep_policy_stats_t mode[SLEEP_POLICY_MODE_NB];
+} sleep_policy_ret_stats_t;
+
+/* Kept across sleep without retention and warm resets */
+static sleep_policy_ret_stats_t sleep_policy_ret __attribute__ ((section(".noinit")));
+
+static const uint8_t sleep_policy_rec_state[SLEEP_POLICY_MODE_NB] =
+{
+    [SLEEP_POLICY_WFI] = POWER_REC_CPU_SLEEP,
+    [SLEEP_POLICY_DEEP_RETENTION] = POWER_REC_DEEP_SLEEP,
+    [SLEEP_POLICY_DEEP_NO_RETENTION] = POWER_REC_DEEP_SLEEP_NO_RET
+};
+
+/**
+ * @brief Time left before the next RTC or BLE deadline
+ * @return time in microseconds
+ */
+static uint64_t SleepPolicy_Time_To_Deadline(void)
+{
+    uint32_t cycles = RTC_ALARM_Get_RemainingCycles();
+    uint32_t ble_next = SleepCoord_Get_BLENextEvent();
+
+    if ((cycles == 0) || ((ble_next != SLEEP_COORD_NO_BLE_EVENT) && (ble_next < cycles)))
+    {
+        cycles = ble_next;
+    }
+
+    if (cycles == SLEEP_COORD_NO_BLE_EVENT)
+    {
+        /* Nothing known, BLE sleep is bounded by MAX_SLEEP_DURATION */
+        cycles = HALF_SLOTS_TO_RTC_CYCLES(MAX_SLEEP_DURATION);
+    }
+
+    return RTC_CYCLES_TO_US(cycles);
+}
+
+/**
+ * @brief Energy spent in a mode for a gap of the given length
+ * @return energy in nJ, UINT64_MAX if the gap is shorter than the mode latency
+ */
+static uint64_t SleepPolicy_Energy(sleep_policy_mode_t mode, uint64_t gap_us)
+{
+    const sleep_policy_cost_t *cost = &sleep_policy_cost[mode];
+
+    if (gap_us <= cost->latency_us)
+    {
+        return UINT64_MAX;
+    }
+
+    /* nW * us = 1e-6 nJ */
+    return cost->energy_nj + ((uint64_t)cost->power_nw * (gap_us - cost->latency_us)) / 1000000;
+}
+
+void SleepPolicy_Init(void)
+{
+    if (sleep_policy_ret.magic != SLEEP_POLICY_STATS_MAGIC)
+    {
+        memset(&sleep_policy_ret, 0, sizeof(sleep_policy_ret));
+        sleep_policy_ret.magic = SLEEP_POLICY_STATS_MAGIC;
+    }
+
+    /* The wakeup from sleep without retention goes through reset */
+    if (sleep_policy_ret.no_ret_pending)
+    {
+        sleep_policy_ret.no_ret_pending = 0;
+        sleep_policy_ret.mode[SLEEP_POLICY_DEEP_NO_RETENTION].entries++;
+    }
+}
+
+void SleepPolicy_Set_Cost(sleep_policy_mode_t mode, const sleep_policy_cost_t *cost)
+{
+    if (mode < SLEEP_POLICY_MODE_NB)
+    {
+        sleep_policy_cost[mode] = *cost;
+    }
+}
+
+sleep_policy_mode_t SleepPolicy_Select(bool deep_sleep_allowed)
+{
+    if (!deep_sleep_allowed)
+    {
+        return SLEEP_POLICY_WFI;
+    }
+
+    uint64_t gap_us = SleepPolicy_Time_To_Deadline();
+    sleep_policy_mode_t best = SLEEP_POLICY_WFI;
+    uint64_t best_energy = SleepPolicy_Energy(SLEEP_POLICY_WFI, gap_us);
+
+    for (uint8_t mode = SLEEP_POLICY_DEEP_RETENTION; mode < SLEEP_POLICY_MODE_NB; mode++)
+    {
+#if (SLEEP_POLICY_NO_RETENTION_ENABLE == 0)
+        if (mode == SLEEP_POLICY_DEEP_NO_RETENTION)
+        {
+            continue;
+        }
+#endif    /* if (SLEEP_POLICY_NO_RETENTION_ENABLE == 0) */
+
+        uint64_t energy = SleepPolicy_Energy(mode, gap_us);
+        if (energy < best_energy)
+        {
+            best_energy = energy;
+            best = mode;
+        }
+    }
+
+    if (best == SLEEP_POLICY_WFI)
+    {
+        sleep_policy_ret.mode[SLEEP_POLICY_WFI].demoted++;
+    }
+
+    return best;
+}
+
+void SleepPolicy_Enter(sleep_policy_mode_t mode)
+{
+    uint64_t start = RTC_Get_Timestamp();
+
+    POWER_REC(sleep_policy_rec_state[mode], POWER_REC_CAUSE_NONE);
+
+    switch (mode)
+    {
+        case SLEEP_POLICY_DEEP_RETENTION:
+        {
+            SOC_Sleep(SLEEP_CORE_RETENTION);
+            break;
+        }
+
+        case SLEEP_POLICY_DEEP_NO_RETENTION:
+        {
+            /* The wakeup does not return to this point, the entry is
+             * counted by SleepPolicy_Init() */
+            sleep_policy_ret.no_ret_pending = 1;
+            SOC_Sleep(SLEEP_NO_RETENTION);
+            break;
+        }
+
+        case SLEEP_POLICY_WFI:
+        default:
+        {
+            /* Wait for interrupt */
+            __WFI();
+            break;
+        }
+    }
+
+    if (mode != SLEEP_POLICY_DEEP_NO_RETENTION)
+    {
+        /* Interrupts are still disabled, the wakeup events are pending */
+        POWER_REC(POWER_REC_RUN, PowerRec_Wakeup_Cause());
+
+        sleep_policy_ret.mode[mode].entries++;
+        sleep_policy_ret.mode[mode].residency_cycles += RTC_Get_Timestamp() - start;
+    }
+}
+
+const sleep_policy_stats_t * SleepPolicy_Get_Stats(sleep_policy_mode_t mode)
+{
+    return &sleep_policy_ret.mode[mode];
+}
+
+void SleepPolicy_Log_Stats(void)
+{
+    for (uint8_t i = 0; i < SLEEP_POLICY_MODE_NB; i++)
+    {
+        const sleep_policy_stats_t *m = SleepPolicy_Get_Stats((sleep_policy_mode_t)i);
+
+        TRACE_LOG("STAT sleep %u entries=%lu ms=%lu demoted=%lu\r\n",
+                  i, m->entries, STATS_REPORT_MS(m->residency_cycles), m->demoted);
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file stats_report.c
+ * @brief Statistics report source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  DIAG
+
+#include "app.h"
+
+static stats_report_section_t stats_report_section[STATS_REPORT_SECTION_NB];
+static uint8_t stats_report_section_nb = 0;
+
+void StatsReport_Add(stats_report_section_t section)
+{
+    if (stats_report_section_nb >= STATS_REPORT_SECTION_NB)
+    {
+        APP_LOG_ERROR("StatsReport: no room for section %u\r\n", stats_report_section_nb);
+        return;
+    }
+
+    stats_report_section[stats_report_section_nb++] = section;
+}
+
+void StatsReport_Periodic(void)
+{
+#if STATS_REPORT_PERIOD
+    static uint16_t stats_report_count = 0;
+    static uint8_t stats_report_next = STATS_REPORT_SECTION_NB;
+
+    /* Compiled out with the other DIAG dumps */
+    if (!APP_LOG_ON(APP_LOG_LEVEL_INFO))
+    {
+        return;
+    }
+
+    if (stats_report_next < stats_report_section_nb)
+    {
+        stats_report_section[stats_report_next++]();
+    }
+    else if (++stats_report_count >= STATS_REPORT_PERIOD)
+    {
+        stats_report_count = 0;
+        stats_report_next = 0;
+    }
+#endif    /* if STATS_REPORT_PERIOD */
+}
@@ -0,0 +1,332 @@
+/**
+ * @file trace_log.c
+ * @brief Deferred trace log source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#include "app.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#define TRACE_LOG_RING_MASK             (TRACE_LOG_RING_SIZE - 1)
+#define TRACE_LOG_DMA_IDLE              0xFF
+
+static uint8_t trace_log_ring[TRACE_LOG_RING_SIZE];
+static volatile uint16_t trace_log_head = 0;    /**< Write index, free running */
+static volatile uint16_t trace_log_tail = 0;    /**< Read index, free running */
+static uint8_t trace_log_seq = 0;               /**< Sequence number of the next record */
+static trace_log_stats_t trace_log_stats;
+
+static uint8_t trace_log_dma_buf[2][TRACE_LOG_DMA_BUF_SIZE];
+static volatile uint8_t trace_log_dma_len[2];                   /**< Bytes to send, 0 if the buffer is free */
+static volatile uint8_t trace_log_dma_active = TRACE_LOG_DMA_IDLE; /**< Buffer being sent */
+static volatile bool trace_log_dma_tail = false;                /**< Last bytes of a transfer still in the UART */
+
+/**
+ * @brief Append a record in the ring, or count it as dropped if it does not fit
+ */
+static void TraceLog_Put(uint16_t fmt_id, uint8_t flags, const uint8_t *payload, uint8_t length)
+{
+    GLOBAL_INT_DISABLE();
+
+    uint16_t used = trace_log_head - trace_log_tail;
+    uint8_t seq = trace_log_seq++ & TRACE_LOG_SEQ_MASK;
+
+    if ((used + TRACE_LOG_HEADER_SIZE + length) > TRACE_LOG_RING_SIZE)
+    {
+        /* The decoder reports the sequence gap */
+        trace_log_stats.dropped++;
+    }
+    else
+    {
+        uint32_t timestamp = (uint32_t)RTC_Get_Timestamp();
+        uint8_t header[TRACE_LOG_HEADER_SIZE] =
+        {
+            fmt_id & 0xFF, fmt_id >> 8, length, flags | seq,
+            timestamp & 0xFF, (timestamp >> 8) & 0xFF,
+            (timestamp >> 16) & 0xFF, timestamp >> 24
+        };
+        uint16_t head = trace_log_head;
+
+        for (uint8_t i = 0; i < TRACE_LOG_HEADER_SIZE; i++)
+        {
+            trace_log_ring[head++ & TRACE_LOG_RING_MASK] = header[i];
+        }
+
+        for (uint8_t i = 0; i < length; i++)
+        {
+            trace_log_ring[head++ & TRACE_LOG_RING_MASK] = payload[i];
+        }
+
+        trace_log_head = head;
+        trace_log_stats.records++;
+
+        used += TRACE_LOG_HEADER_SIZE + length;
+        if (used > trace_log_stats.peak_bytes)
+        {
+            trace_log_stats.peak_bytes = used;
+        }
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ * @brief COBS encode a record so it contains no 0x00, the frame delimiter
+ * @return encoded length, length + 1 for records shorter than 254 bytes
+ */
+static uint8_t TraceLog_Encode(const uint8_t *src, uint8_t length, uint8_t *dst)
+{
+    uint8_t code_index = 0;
+    uint8_t out = 1;
+    uint8_t code = 1;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (src[i] == 0)
+        {
+            dst[code_index] = code;
+            code_index = out++;
+            code = 1;
+        }
+        else
+        {
+            dst[out++] = src[i];
+            code++;
+        }
+    }
+
+    dst[code_index] = code;
+
+    return out;
+}
+
+/**
+ * @brief Start sending a DMA buffer. Called with interrupts disabled.
+ */
+static void TraceLog_DMA_Start(uint8_t index)
+{
+    trace_log_dma_active = index;
+
+    TRACE_LOG_UART_DMA_ENABLE();
+    Sys_DMA_ChannelConfig(TRACE_LOG_DMA, TRACE_LOG_DMA_CFG, trace_log_dma_len[index], 0,
+                          (uint32_t)trace_log_dma_buf[index], (uint32_t)&UART->TX_DATA);
+
+    trace_log_stats.dma_transfers++;
+    trace_log_stats.sent_bytes += trace_log_dma_len[index];
+}
+
+/**
+ * @brief Move as many records as fit from the ring to a DMA buffer. Called
+ *        with interrupts disabled, the drain and the DMA interrupt both
+ *        move the tail.
+ * @return number of bytes in the buffer
+ */
+static uint8_t TraceLog_Fill(uint8_t *buf)
+{
+    uint8_t record[TRACE_LOG_HEADER_SIZE + TRACE_LOG_MAX_PAYLOAD];
+    uint8_t fill = 0;
+
+    while (TraceLog_Pending())
+    {
+        uint16_t tail = trace_log_tail;
+        uint8_t length = TRACE_LOG_HEADER_SIZE + trace_log_ring[(tail + 2) & TRACE_LOG_RING_MASK];
+
+        /* Leading delimiter, COBS overhead byte, trailing delimiter */
+        if ((fill + length + 3) > TRACE_LOG_DMA_BUF_SIZE)
+        {
+            break;
+        }
+
+        /* Writers only fill bytes past the head */
+        for (uint8_t i = 0; i < length; i++)
+        {
+            record[i] = trace_log_ring[tail++ & TRACE_LOG_RING_MASK];
+        }
+
+        trace_log_tail = tail;
+
+        /* A delimiter before the frame separates it from swmTrace text */
+        buf[fill++] = 0x00;
+        fill += TraceLog_Encode(record, length, &buf[fill]);
+        buf[fill++] = 0x00;
+    }
+
+    return fill;
+}
+
+void TraceLog_Write(uint16_t fmt_id, const uint32_t *args, uint8_t nargs)
+{
+    if (nargs > TRACE_LOG_MAX_ARGS)
+    {
+        nargs = TRACE_LOG_MAX_ARGS;
+    }
+
+    /* Arguments are stored little endian, as in memory */
+    TraceLog_Put(fmt_id, 0, (const uint8_t *)args, nargs * sizeof(uint32_t));
+}
+
+/**
+ * @brief Append bytes in records of at most TRACE_LOG_MAX_PAYLOAD bytes
+ */
+static void TraceLog_Put_Split(uint16_t fmt_id, uint8_t flags, const uint8_t *data, uint16_t length)
+{
+    do
+    {
+        uint8_t chunk = (length > TRACE_LOG_MAX_PAYLOAD) ? TRACE_LOG_MAX_PAYLOAD : length;
+
+        TraceLog_Put(fmt_id, flags, data, chunk);
+        data += chunk;
+        length -= chunk;
+    } while (length);
+}
+
+void TraceLog_Write_Hex(uint16_t fmt_id, const uint8_t *data, uint16_t length)
+{
+    TraceLog_Put_Split(fmt_id, TRACE_LOG_FLAG_HEX, data, length);
+}
+
+void TraceLog_Text(const char *fmt, ...)
+{
+    char text[TRACE_LOG_TEXT_MAX];
+    va_list args;
+    int length;
+
+    va_start(args, fmt);
+    length = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    if (length <= 0)
+    {
+        return;
+    }
+
+    if (length >= (int)sizeof(text))
+    {
+        length = sizeof(text) - 1;
+    }
+
+    TraceLog_Put_Split(TRACE_LOG_FMT_TEXT, 0, (const uint8_t *)text, length);
+    trace_log_stats.texts++;
+}
+
+/**
+ * @brief Fill a free DMA buffer from the ring. Called with interrupts
+ *        disabled.
+ * @return true if the buffer holds records to send
+ */
+static bool TraceLog_Refill(uint8_t index)
+{
+    if (trace_log_dma_len[index] == 0)
+    {
+        trace_log_dma_len[index] = TraceLog_Fill(trace_log_dma_buf[index]);
+    }
+
+    return (trace_log_dma_len[index] != 0);
+}
+
+void TraceLog_Drain(void)
+{
+    /* The DMA interrupt keeps draining the ring once a transfer runs. Text
+     * still in the swmTrace buffer goes first, the UART would mix both. */
+    if (!TraceLog_Pending() || TraceLog_Busy() || Trace_Pending())
+    {
+        return;
+    }
+
+    /* The UART may not be configured since the last wakeup */
+    Trace_Open();
+
+    GLOBAL_INT_DISABLE();
+
+    if ((trace_log_dma_active == TRACE_LOG_DMA_IDLE) && TraceLog_Refill(0))
+    {
+        TraceLog_DMA_Start(0);
+
+        /* Ready for the end of the first transfer */
+        TraceLog_Refill(1);
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+void TRACE_LOG_DMA_IRQHandler(void)
+{
+    uint8_t done = trace_log_dma_active;
+
+    Sys_DMA_ClearAllStatus(TRACE_LOG_DMA);
+
+    if (done == TRACE_LOG_DMA_IDLE)
+    {
+        return;
+    }
+
+    trace_log_dma_len[done] = 0;
+
+    /* Records written during the transfer are sent without waiting for
+     * the main loop, the sent buffer is filled while the other one goes */
+    if (TraceLog_Refill(done ^ 1))
+    {
+        TraceLog_DMA_Start(done ^ 1);
+        TraceLog_Refill(done);
+    }
+    else
+    {
+        /* The DMA is done once it wrote the last byte to the UART, that
+         * byte is still being shifted out */
+        trace_log_dma_active = TRACE_LOG_DMA_IDLE;
+        trace_log_dma_tail = true;
+        TRACE_LOG_UART_DMA_DISABLE();
+    }
+}
+
+bool TraceLog_Busy(void)
+{
+    if (trace_log_dma_active != TRACE_LOG_DMA_IDLE)
+    {
+        return true;
+    }
+
+    /* Only the DMA interrupt sets the tail, and only during a transfer */
+    if (trace_log_dma_tail)
+    {
+        if (TRACE_UART_TX_BUSY())
+        {
+            return true;
+        }
+
+        trace_log_dma_tail = false;
+    }
+
+    return false;
+}
+
+bool TraceLog_Pending(void)
+{
+    return (trace_log_head != trace_log_tail);
+}
+
+const trace_log_stats_t * TraceLog_Get_Stats(void)
+{
+    return &trace_log_stats;
+}
+
+void TraceLog_Log_Stats(void)
+{
+    const trace_log_stats_t *t = TraceLog_Get_Stats();
+
+    TRACE_LOG("STAT trace records=%lu dropped=%lu texts=%lu bytes=%lu dma=%lu peak=%u\r\n",
+              t->records, t->dropped, t->texts, t->sent_bytes, t->dma_transfers,
+              t->peak_bytes);
+}
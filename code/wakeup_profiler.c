@@ -0,0 +1,266 @@
+/**
+ * @file wakeup_profiler.c
+ * @brief Wakeup profiler source file
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#define APP_LOG_MODULE                  DIAG
+
+#include "app.h"
+#include <string.h>
+#include <stdio.h>
+
+/* SysTick is a 24-bit down counter */
+#define PROFILER_SYSTICK_MAX            0x00FFFFFF
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t bucket[PROFILER_PHASE_NB][PROFILER_BUCKET_NB];
+    uint32_t max_us[PROFILER_PHASE_NB];
+} profiler_histograms_t;
+
+/* Kept across sleep and warm resets */
+static profiler_histograms_t profiler_hist __attribute__ ((section(".noinit")));
+
+static uint32_t profiler_ts[PROFILER_POINT_NB];     /**< Timestamps of current cycle (us) */
+static uint32_t profiler_valid = 0;                 /**< Points reached in current cycle */
+static uint32_t profiler_wraps = 0;                 /**< SysTick wraps in current cycle */
+static uint32_t profiler_base_us = 0;               /**< Time at the last clock change (us) */
+static uint32_t profiler_base_cycles = 0;           /**< Counter at the last clock change */
+static bool profiler_sleeping = false;              /**< SysTick stopped by sleep */
+
+static const char *const profiler_phase_name[PROFILER_PHASE_NB] =
+{
+    [PROFILER_PHASE_WAKEUP_TO_SCHED] = "wakeup->sched",
+    [PROFILER_PHASE_SCHED] = "sched",
+    [PROFILER_PHASE_TASK] = "task",
+    [PROFILER_PHASE_RTC_TO_SLEEP] = "rtc->sleep",
+    [PROFILER_PHASE_ACTIVE] = "active"
+};
+
+/**
+ * @brief Restart SysTick as a free running counter at the core clock
+ */
+static void Profiler_Timer_Start(void)
+{
+    SysTick->CTRL = 0;
+    SysTick->LOAD = PROFILER_SYSTICK_MAX;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+    profiler_wraps = 0;
+    profiler_base_us = 0;
+    profiler_base_cycles = 0;
+}
+
+/**
+ * @brief Core clock cycles since Profiler_Timer_Start()
+ */
+static uint32_t Profiler_Timer_Read(void)
+{
+    uint32_t val = SysTick->VAL;
+
+    /* COUNTFLAG is cleared on read, only one wrap between two marks is seen */
+    if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk)
+    {
+        profiler_wraps++;
+        val = SysTick->VAL;
+    }
+
+    return (profiler_wraps * (PROFILER_SYSTICK_MAX + 1)) + (PROFILER_SYSTICK_MAX - val);
+}
+
+/**
+ * @brief Time since Profiler_Timer_Start(). Cycles are converted with the
+ *        clock they were counted at, see Profiler_Clock_Change().
+ */
+static uint32_t Profiler_Time_Us(void)
+{
+    return profiler_base_us + ((Profiler_Timer_Read() - profiler_base_cycles) / (SystemCoreClock / 1000000));
+}
+
+/**
+ * @brief Add a duration to a phase histogram
+ */
+static void Profiler_Record(profiler_phase_t phase, profiler_point_t from, profiler_point_t to)
+{
+    if (!(profiler_valid & (1U << from)))
+    {
+        return;
+    }
+
+    uint32_t us = profiler_ts[to] - profiler_ts[from];
+    uint32_t bucket = 31 - __CLZ(us | 1);
+
+    if (bucket >= PROFILER_BUCKET_NB)
+    {
+        bucket = PROFILER_BUCKET_NB - 1;
+    }
+
+    profiler_hist.bucket[phase][bucket]++;
+    if (us > profiler_hist.max_us[phase])
+    {
+        profiler_hist.max_us[phase] = us;
+    }
+}
+
+void Profiler_Init(void)
+{
+    if (profiler_hist.magic != PROFILER_MAGIC)
+    {
+        Profiler_Reset();
+    }
+
+    profiler_valid = 0;
+    profiler_sleeping = false;
+    Profiler_Timer_Start();
+}
+
+void Profiler_Reset(void)
+{
+    memset(&profiler_hist, 0, sizeof(profiler_hist));
+    profiler_hist.magic = PROFILER_MAGIC;
+}
+
+uint32_t Profiler_Get_Cycles(void)
+{
+    return Profiler_Timer_Read();
+}
+
+void Profiler_Clock_Change(void)
+{
+    GLOBAL_INT_DISABLE();
+
+    uint32_t cycles = Profiler_Timer_Read();
+
+    profiler_base_us += (cycles - profiler_base_cycles) / (SystemCoreClock / 1000000);
+    profiler_base_cycles = cycles;
+
+    GLOBAL_INT_RESTORE();
+}
+
+void Profiler_Mark(profiler_point_t point)
+{
+    if (point == PROFILER_POINT_WAKEUP)
+    {
+        /* Wakeup interrupts also fire in run mode, only a wakeup from sleep
+         * starts a new cycle. SysTick does not run in sleep, each cycle
+         * starts from zero. */
+        if (!profiler_sleeping)
+        {
+            return;
+        }
+
+        profiler_sleeping = false;
+        Profiler_Timer_Start();
+        profiler_valid = 0;
+    }
+
+    profiler_ts[point] = Profiler_Time_Us();
+
+    switch (point)
+    {
+        case PROFILER_POINT_SCHED_START:
+        {
+            Profiler_Record(PROFILER_PHASE_WAKEUP_TO_SCHED, PROFILER_POINT_WAKEUP, point);
+            break;
+        }
+
+        case PROFILER_POINT_TASK_END:
+        {
+            Profiler_Record(PROFILER_PHASE_TASK, PROFILER_POINT_TASK_START, point);
+            break;
+        }
+
+        case PROFILER_POINT_RTC_RECONFIG:
+        {
+            Profiler_Record(PROFILER_PHASE_SCHED, PROFILER_POINT_SCHED_START, point);
+            break;
+        }
+
+        case PROFILER_POINT_SLEEP_ENTER:
+        {
+            Profiler_Record(PROFILER_PHASE_RTC_TO_SLEEP, PROFILER_POINT_RTC_RECONFIG, point);
+            Profiler_Record(PROFILER_PHASE_ACTIVE, PROFILER_POINT_WAKEUP, point);
+
+            /* Only the next wakeup starts a new cycle */
+            profiler_valid = 0;
+            profiler_sleeping = true;
+            return;
+        }
+
+        default:
+        {
+        }
+    }
+
+    profiler_valid |= (1U << point);
+}
+
+uint16_t Profiler_Get_Histogram(uint8_t phase, uint8_t *buf, uint16_t len)
+{
+    uint16_t idx = 0;
+
+    if ((phase >= PROFILER_PHASE_NB) || (len < 2))
+    {
+        return 0;
+    }
+
+    buf[idx++] = phase;
+    buf[idx++] = PROFILER_BUCKET_NB;
+
+    for (uint8_t i = 0; (i < PROFILER_BUCKET_NB) && ((idx + 2) <= len); i++)
+    {
+        uint32_t count = profiler_hist.bucket[phase][i];
+        uint16_t value = (count > UINT16_MAX) ? UINT16_MAX : (uint16_t)count;
+
+        buf[idx++] = (uint8_t)value;
+        buf[idx++] = (uint8_t)(value >> 8);
+    }
+
+    return idx;
+}
+
+void Profiler_Log(void)
+{
+    /* One line per phase, "%lu " per bucket */
+    char line[PROFILER_BUCKET_NB * 11 + 1];
+
+    APP_LOG_INFO("\n\rWakeup profile (log2 us buckets):\n\r");
+    for (uint8_t phase = 0; phase < PROFILER_PHASE_NB; phase++)
+    {
+        uint16_t len = 0;
+
+        for (uint8_t i = 0; i < PROFILER_BUCKET_NB; i++)
+        {
+            len += snprintf(&line[len], sizeof(line) - len, " %lu", profiler_hist.bucket[phase][i]);
+        }
+
+        APP_LOG_INFO("%s max=%lu us:%s\n\r", profiler_phase_name[phase],
+                     profiler_hist.max_us[phase], line);
+    }
+}
+
+void Profiler_Log_Periodic(void)
+{
+#if PROFILER_LOG_PERIOD
+    static uint16_t profiler_log_count = 0;
+
+    if (++profiler_log_count >= PROFILER_LOG_PERIOD)
+    {
+        profiler_log_count = 0;
+        Profiler_Log();
+    }
+#endif    /* if PROFILER_LOG_PERIOD */
+}
@@ -19,6 +19,9 @@
 #include "sensor.h"
 #include "app.h"
 
+/* Value loaded into the RTC counter by the last RTC_ALARM_Reconfig() call */
+static uint32_t rtc_loaded_counter = 0xDEADBEEF;
+
 void Wakeup_Source_Config(void)
 {
     /* Configure and enable RTC wakeup source */
@@ -177,6 +180,7 @@ uint32_t RTC_ALARM_Reconfig(uint32_t timer_counter, uint32_t pre_timer_counter,
         rtc_config_val = timer_counter - 1 - ((0xDEADBEEF) - rtc_counter);
         ACS->RTC_CFG = rtc_config_val;
     }
+    rtc_loaded_counter = rtc_config_val;
 
     /* Configure GPIO3 interrupt line to falling edge of GPIO8(standby clock) */
     Sys_GPIO_IntConfig(3, NS_CANNOT_ACCESS_GPIO_INT | GPIO_DEBOUNCE_DISABLE | GPIO_EVENT_FALLING_EDGE | GPIO_SRC_GPIO_8,
@@ -207,14 +211,8 @@ uint32_t RTC_ALARM_Reconfig(uint32_t timer_counter, uint32_t pre_timer_counter,
     /* Reset GPIO8 */
     SYS_GPIO_CONFIG(8, GPIO_2X_DRIVE | GPIO_LPF_DISABLE | GPIO_WEAK_PULL_UP | NS_CANNOT_USE_GPIO | GPIO_MODE_DISABLE);
 
-    /* Restore NVIC set enable register */
-    NVIC->ISER[0] = nvic_set_enable[0];
-    NVIC->ISER[1] = nvic_set_enable[1];
-
-    /* Unmask interrupt */
-    __enable_irq();
-
-    /* Increment total RTC cycles count as necessary */
+    /* Increment total RTC cycles count as necessary, together with
+     * rtc_loaded_counter so RTC_Get_Timestamp() never goes backwards */
     if (startup_check == 0)
     {
         total_RTC_cycles += (0xDEADBEEF - rtc_counter);
@@ -232,5 +230,51 @@ uint32_t RTC_ALARM_Reconfig(uint32_t timer_counter, uint32_t pre_timer_counter,
         }
     }
 
+    /* Restore NVIC set enable register */
+    NVIC->ISER[0] = nvic_set_enable[0];
+    NVIC->ISER[1] = nvic_set_enable[1];
+
+    /* Unmask interrupt */
+    __enable_irq();
+
     return rtc_config_val;
 }
+
+/**
+ * @brief Read number of RTC cycles left before the programmed RTC alarm
+ * @return remaining RTC cycles, 0 if the alarm has already expired
+ */
+uint32_t RTC_ALARM_Get_RemainingCycles(void)
+{
+    uint32_t rtc_counter = RTC_Timer_Counter_Read();
+
+    /* Once the alarm fires the counter reloads 0xDEADBEEF and keeps
+     * counting down from there */
+    if (rtc_counter > rtc_loaded_counter)
+    {
+        return 0;
+    }
+
+    return rtc_counter;
+}
+
+/**
+ * @brief Read current time as total elapsed RTC cycles
+ * @return total_RTC_cycles plus cycles elapsed since last RTC_ALARM_Reconfig()
+ */
+uint64_t RTC_Get_Timestamp(void)
+{
+    uint32_t rtc_counter = RTC_Timer_Counter_Read();
+    uint32_t elapsed;
+
+    if (rtc_counter <= rtc_loaded_counter)
+    {
+        elapsed = rtc_loaded_counter - rtc_counter;
+    }
+    else
+    {
+        elapsed = rtc_loaded_counter + 1 + (0xDEADBEEF - rtc_counter);
+    }
+
+    return (total_RTC_cycles + elapsed);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file adv_data.h
+ * @brief Advertising data builder header file, keeps dynamic values in the
+ *        manufacturer specific data and updates them while advertising
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef ADV_DATA_H_
+#define ADV_DATA_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Manufacturer specific data layout, after the company ID:
+ *   - battery level (%), 1 byte
+ *   - advertising window counter, 2 bytes little endian */
+#define ADV_DATA_BATTERY_OFFSET         0
+#define ADV_DATA_BATTERY_SIZE           1
+#define ADV_DATA_COUNTER_OFFSET         1
+#define ADV_DATA_COUNTER_SIZE           2
+#define ADV_DATA_SLOTS_LEN              3
+
+/* The stack adds the flags field (length, type, value) in front of the
+ * application data of a legacy advertising set */
+#define ADV_DATA_FLAGS_LEN              3
+#define ADV_DATA_MAX_LEN                (ADV_DATA_LEN - ADV_DATA_FLAGS_LEN)
+
+/**
+ * @brief Dynamic fields of the advertising data
+ */
+typedef enum
+{
+    ADV_DATA_SLOT_BATTERY = 0,
+    ADV_DATA_SLOT_COUNTER,
+    ADV_DATA_SLOT_NB
+} adv_data_slot_t;
+
+/**
+ * @brief Advertising data update statistics
+ */
+typedef struct
+{
+    uint32_t updates;                       /**< Data sent to the running activity */
+    uint32_t unchanged;                     /**< Updates skipped as the bytes did not change */
+    uint32_t errors;                        /**< Updates rejected by the stack */
+} adv_data_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Build the advertising data: device name, company ID and slots.
+ *        The slots are left out if they do not fit after the flags.
+ */
+void AdvData_Build(void);
+
+/**
+ * @brief Write a dynamic field and send the advertising data if it changed.
+ *
+ * @param[in] slot  Field to write
+ * @param[in] value Field value, truncated to the field size
+ */
+void AdvData_Set_Slot(adv_data_slot_t slot, uint32_t value);
+
+/**
+ * @brief Send the advertising data to the activity if it changed since the
+ *        last update and no update is in progress.
+ */
+void AdvData_Push(void);
+
+/**
+ * @brief Set the advertising and scan response data of a new activity. Live
+ *        updates wait for the completion of this data.
+ *
+ * @param[in] actv_idx Advertising activity index
+ */
+void AdvData_Activity_Created(uint8_t actv_idx);
+
+/**
+ * @brief Handle GAPM_CMP_EVT / GAPM_SET_ADV_DATA.
+ *
+ * @param[in] status Completion status
+ *
+ * @return true if it completes a live update, false if it completes the
+ *         data of a new activity
+ */
+bool AdvData_Complete(uint8_t status);
+
+/**
+ * @brief Read advertising data update statistics
+ *
+ * @return Pointer to statistics
+ */
+const adv_data_stats_t * AdvData_Get_Stats(void);
+
+/**
+ * @brief Log the advertising data updates, one section of the statistics
+ *        report
+ */
+void AdvData_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* ADV_DATA_H_ */
@@ -0,0 +1,157 @@
+/**
+ * @file adv_policy.h
+ * @brief Advertising policy header file, selects the advertising window
+ *        length, off time and interval from the recent connection activity,
+ *        bonded peers and battery level
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef ADV_POLICY_H_
+#define ADV_POLICY_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Default window, used when nothing else applies (seconds) */
+#define ADV_POLICY_ON_S                 BLE_ADV_ON_DURATION
+#define ADV_POLICY_OFF_S                BLE_ADV_OFF_DURATION
+
+/* Busy site: a peer connected recently or is trying to, advertise longer
+ * and more often to cut reconnection latency (seconds) */
+#define ADV_POLICY_RECENT_S             300
+#define ADV_POLICY_BUSY_ON_S            15
+#define ADV_POLICY_BUSY_OFF_S           15
+
+/* Quiet site: no connection for this long, the off time doubles every
+ * window up to ADV_POLICY_OFF_MAX_S and the interval is slowed (seconds) */
+#define ADV_POLICY_QUIET_S              3600
+#define ADV_POLICY_OFF_MAX_S            540
+
+/* Longest off time while a bonded peer may come back (seconds) */
+#define ADV_POLICY_BONDED_OFF_MAX_S     120
+
+/* Shortest window when battery is critical (seconds) */
+#define ADV_POLICY_ON_MIN_S             3
+
+/* Battery thresholds (percent) */
+#define ADV_POLICY_BATT_LOW             BATT_LEVEL_LOW_THRESHOLD_PERCENT
+#define ADV_POLICY_BATT_CRITICAL        5
+
+/* Slow advertising interval used at quiet sites and low battery
+ * (units of 625us, up to 10.24s) */
+#define ADV_POLICY_SLOW_INTERVAL        (((APP_ADV_INT_MIN * 4) < 16384) ? (APP_ADV_INT_MIN * 4) : 16384)
+
+/**
+ * @brief Decision for the next advertising window
+ */
+typedef struct
+{
+    uint16_t on_s;                          /**< Window length (seconds) */
+    uint16_t off_s;                         /**< Time without advertising after the window (seconds) */
+    uint16_t interval;                      /**< Advertising interval (units of 625us) */
+} adv_policy_decision_t;
+
+/**
+ * @brief Advertising policy statistics
+ */
+typedef struct
+{
+    uint32_t windows;                       /**< Advertising windows started */
+    uint32_t connections;                   /**< Connections received */
+    uint32_t interval_changes;              /**< Activity re-created with a new interval */
+    uint64_t adv_cycles;                    /**< Time with advertising enabled (RTC cycles) */
+    adv_policy_decision_t last;             /**< Last decision */
+} adv_policy_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize the advertising policy with the default window.
+ */
+void AdvPolicy_Initialize(void);
+
+/**
+ * @brief Start or end an advertising window.
+ *
+ * @param[in] window_on true to start advertising, false to stop
+ *
+ * @return Seconds until the next call, window length when starting and
+ *         off time when stopping
+ */
+uint16_t AdvPolicy_Window(bool window_on);
+
+/**
+ * @brief Compute the decision for the next window from the current inputs
+ *
+ * @return Pointer to the decision
+ */
+const adv_policy_decision_t * AdvPolicy_Evaluate(void);
+
+/**
+ * @brief Record a connection, called on GAPC_CONNECTION_REQ_IND
+ */
+void AdvPolicy_On_Connection(void);
+
+/**
+ * @brief Record a disconnection, called on GAPC_DISCONNECT_IND
+ */
+void AdvPolicy_On_Disconnection(void);
+
+/**
+ * @brief Handle the advertising activity deletion needed to change its
+ *        interval.
+ */
+void AdvPolicy_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                          ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read advertising policy statistics
+ *
+ * @return Pointer to statistics
+ */
+const adv_policy_stats_t * AdvPolicy_Get_Stats(void);
+
+/**
+ * @brief Log the advertising windows, connections and last decision, one
+ *        section of the statistics report
+ */
+void AdvPolicy_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* ADV_POLICY_H_ */
@@ -37,6 +37,7 @@ extern "C"
 #include <flash_rom.h>
 #include <ble_protocol_support.h>
 #include <ble_abstraction.h>
+#include <ke_event.h>
 
 /* Application headers */
 #include <app_customss.h>
@@ -44,7 +45,26 @@ extern "C"
 #include <app_init.h>
 #include <app_msg_handler.h>
 #include "calibration.h"
+#include "app_trace.h"
+#include "trace_log.h"
+#include "app_dispatch.h"
+#include "clock_manager.h"
+#include "power_resource.h"
+#include "adv_policy.h"
+#include "adv_data.h"
+#include "broadcast.h"
+#include "ntf_queue.h"
+#include "conn_policy.h"
+#include "phy_manager.h"
+#include "l2cap_offload.h"
+#include "bond_cache.h"
 #include "wakeup_source_config.h"
+#include "sleep_coordinator.h"
+#include "sleep_policy.h"
+#include "wakeup_profiler.h"
+#include "power_recorder.h"
+#include "heap_profile.h"
+#include "stats_report.h"
 
 #include "scheduler.h"
 #include "scheduler_tasks.h"
@@ -54,6 +74,8 @@ enum appm_msg
 {
     APPM_DUMMY_MSG = TASK_FIRST_MSG(TASK_ID_APP),
     BLE_STATES_TIMEOUT,
+    CONN_POLICY_IDLE_TIMEOUT,
+    PHY_MGR_RSSI_TIMEOUT,
 };
 
 /* ----------------------------------------------------------------------------
@@ -79,16 +101,22 @@ enum appm_msg
 #define DEBUG_SLEEP_GPIO                1
 
 /* Set this to 1 to Power Down FPU
- * note: If FPU is used during run mode this should be left 0 */
-#define POWER_DOWN_FPU                  0
+ * note: The application does no floating point arithmetic, code that does
+ * must hold POWER_DOMAIN_FPU with PowerRes_Acquire(). Set this to 0 if a
+ * library uses the FPU. */
+#define POWER_DOWN_FPU                  1
 
 /* Set this to 1 to Power Down Debug Unit
- * note: If Debug Port is used during run mode this should be left 0 */
-#define POWER_DOWN_DBG                  0
+ * note: A debugger attached at boot (hold DEBUG_CATCH_GPIO low) keeps it
+ * powered. If Debug Port is used after boot this should be set to 0 */
+#define POWER_DOWN_DBG                  1
 
 /* Disable VDDIF interface regulator */
 #define VDDIF_POWER_DOWN                1
 
+/* Domains set to 1 above are powered down at boot and only powered while
+ * acquired with PowerRes_Acquire(), domains set to 0 stay powered */
+
 /* Power Reduction Defines End */
 
 /* Sensor Calibration mode */
@@ -121,12 +149,13 @@ enum appm_msg
 
 #if defined (CFG_REDUCED_DRAM)
 #define CFG_ADV_INTERVAL_MS             5000
+#include "dram_power_mask.h"
 #endif    /* if defined (CFG_REDUCED_DRAM) */
 
 /* Define the advertisement interval for connectable mode (units of 625us)
  * Notes: the interval can be 20ms up to 10.24s */
 #ifdef CFG_ADV_INTERVAL_MS
-#define ADV_INT_CONNECTABLE_MODE        (CFG_ADV_INTERVAL_MS / 0.625)
+#define ADV_INT_CONNECTABLE_MODE        (CFG_ADV_INTERVAL_MS * 8 / 5)
 #else    /* ifdef CFG_ADV_INTERVAL_MS */
 #define ADV_INT_CONNECTABLE_MODE        64
 #endif    /* ifdef CFG_ADV_INTERVAL_MS */
@@ -134,7 +163,7 @@ enum appm_msg
 /* Define the advertisement interval for non-connectable mode (units of 625us)
  * Notes: the minimum interval for non-connectable advertising should be 100ms */
 #ifdef CFG_ADV_INTERVAL_MS
-#define ADV_INT_NON_CONNECTABLE_MODE    (CFG_ADV_INTERVAL_MS / 0.625)
+#define ADV_INT_NON_CONNECTABLE_MODE    (CFG_ADV_INTERVAL_MS * 8 / 5)
 #else    /* ifdef CFG_ADV_INTERVAL_MS */
 #define ADV_INT_NON_CONNECTABLE_MODE    160
 #endif    /* ifdef CFG_ADV_INTERVAL_MS */
@@ -188,6 +217,7 @@ enum appm_msg
 /* Defines the Low power clock accuracy in ppm */
 #define LOW_POWER_CLOCK_ACCURACY        500
 
+/* System clock after boot and wakeup, must match CLOCK_LEVEL_LOW */
 #define SYSTEM_CLK                      8000000
 
 /* Set UART peripheral clock */
@@ -288,8 +318,9 @@ enum appm_msg
 #define AOUT_ENABLE_DELAY               SystemCoreClock / 100    /* delay set to 10ms */
 #define AOUT_GPIO                       2
 
-/* convert time(ms) to RTC timer counter value */
-#define CONVERT_MS_TO_32K_CYCLES(x) (x * 32.768)
+/* convert time(ms) to RTC timer counter value, in integer arithmetic so it
+ * does not need the FPU */
+#define CONVERT_MS_TO_32K_CYCLES(x)     ((uint32_t)((uint64_t)(x) * 32768 / 1000))
 
 /* Flag to make sure wakeup happened due to RTC */
 extern uint8_t wakeup_due_to_RTC;
@@ -303,7 +334,7 @@ extern uint64_t total_RTC_cycles;
 * --------------------------------------------------------------------------*/
 void Main_Loop(void);
 
-void SOC_Sleep(void);
+void SOC_Sleep(uint8_t sleep_type);
 
 void BLE_Sleep_App(void);
 
@@ -48,10 +48,19 @@ extern "C"
 #define LSAD_BATMON_CH                    6
 #define LSAD_GND_CH                       0
 
+/* Samples in the running average of APP_BASS_MeasureBatteryLevel() */
+#define APP_BASS_AVG_NB                   16
+
 void APP_BASS_SetBatMonAlarm(uint32_t supplyThresholdCfg);
 
+void APP_BASS_Init(void);
+
+uint8_t APP_BASS_MeasureBatteryLevel(void);
+
 uint8_t APP_BASS_ReadBatteryLevel(uint8_t bas_nb);
 
+uint8_t APP_BASS_GetCachedBatteryLevel(void);
+
 void APP_BASS_BattLevelLow_Handler(ke_msg_id_t const msg_id,
                                    void const *param,
                                    ke_task_id_t const dest_id,
@@ -30,6 +30,9 @@ extern "C"
  * Include files
  * --------------------------------------------------------------------------*/
 #include <gattc_task.h>
+#include <ble_protocol_config.h>
+#include "wakeup_profiler.h"
+#include "ntf_queue.h"
 
 /* ----------------------------------------------------------------------------
  * Defines
@@ -53,14 +56,57 @@ extern "C"
 #define CS_CHAR_LONG_TX_UUID            { 0x24, 0xdc, 0x0e, 0x6e, 0x04, 0x40, \
                                           0xca, 0x9e, 0xe5, 0xa9, 0xa3, 0x00, \
                                           0xb5, 0xf3, 0x93, 0xe0 }
+#define CS_CHAR_DIAG_UUID               { 0x24, 0xdc, 0x0e, 0x6e, 0x06, 0x40, \
+                                          0xca, 0x9e, 0xe5, 0xa9, 0xa3, 0x00, \
+                                          0xb5, 0xf3, 0x93, 0xe0 }
+#define CS_CHAR_STREAM_UUID             { 0x24, 0xdc, 0x0e, 0x6e, 0x07, 0x40, \
+                                          0xca, 0x9e, 0xe5, 0xa9, 0xa3, 0x00, \
+                                          0xb5, 0xf3, 0x93, 0xe0 }
 
 #define CS_VALUE_MAX_LENGTH          20
 #define CS_LONG_VALUE_MAX_LENGTH     40
 
+/* Diagnostics value: phase, bucket count and one uint16_t per bucket */
+#define CS_DIAG_VALUE_MAX_LENGTH     (2 + 2 * PROFILER_BUCKET_NB)
+
+/* Stream value: largest notification payload (ATT MTU minus 3 byte header) */
+#define CS_STREAM_VALUE_MAX_LENGTH   (APP_STREAM_MTU - 3)
+
+/* ATT MTU and LE data length before any exchange */
+#define CS_STREAM_DEFAULT_MTU        23
+#define CS_STREAM_DEFAULT_TX_OCTETS  27
+
+/* Sequence number tagging stream notifications in GATTC_CMP_EVT */
+#define CS_STREAM_SEQ_NUM            0x5A5A
+
+/* Sequence number tagging RX long value indications in GATTC_CMP_EVT */
+#define CS_IND_SEQ_NUM               0x5A5C
+
+/* Times a failed RX long value indication is sent again before the value
+ * is dropped */
+#define CS_IND_RETRY_MAX             3
+
+/* Bytes sent by the built-in test pattern source when no source is set */
+#define CS_STREAM_TEST_LENGTH        (64 * 1024)
+
 #define CS_TX_CHAR_NAME            "TX_VALUE"
 #define CS_RX_CHAR_NAME            "RX_VALUE"
 #define CS_TX_CHAR_LONG_NAME       "TX_VALUE_LONG"
 #define CS_RX_CHAR_LONG_NAME       "RX_VALUE_LONG"
+#define CS_DIAG_CHAR_NAME          "DIAG_VALUE"
+#define CS_STREAM_CHAR_NAME        "STREAM_VALUE"
+
+/* Set this to 1 to serve every connection from one notification timer.
+ * A pass runs on the first wakeup (connection event, advertising event or
+ * RTC) after the notification period elapsed, so the notifications go out
+ * at each link's next connection event without a wakeup of their own. The
+ * timer is only a fallback, armed CUSTOMSS_NTF_ALIGN_SLACK_MS later.
+ * Set this to 0 to arm one timer per connection index. */
+#define CUSTOMSS_NTF_COALESCE        1
+
+/* Time a notification pass may wait for an existing wakeup, longer than the
+ * connection interval (units of 1ms) */
+#define CUSTOMSS_NTF_ALIGN_SLACK_MS  100
 
 /* Uncomment to use indications in the RX_VALUE_LONG characteristic */
 /* #define RX_VALUE_LONG_INDICATION */
@@ -102,10 +148,36 @@ enum CS_att
     CS_RX_LONG_VALUE_CCC0,
     CS_RX_LONG_VALUE_USR_DSCP0,
 
+    /* Diagnostics Characteristic in Service 0, write a phase number then
+     * read its wakeup profiler histogram */
+    CS_DIAG_VALUE_CHAR0,
+    CS_DIAG_VALUE_VAL0,
+    CS_DIAG_VALUE_USR_DSCP0,
+
+    /* Stream Characteristic in Service 0, notifications sized to the
+     * negotiated MTU and data length */
+    CS_STREAM_VALUE_CHAR0,
+    CS_STREAM_VALUE_VAL0,
+    CS_STREAM_VALUE_CCC0,
+    CS_STREAM_VALUE_USR_DSCP0,
+
     /* Max number of services and characteristics */
     CS_NB,
 };
 
+/* Client characteristic configurations kept per link */
+enum CS_ccc
+{
+    CS_CCC_TX,
+    CS_CCC_RX,
+    CS_CCC_TX_LONG,
+    CS_CCC_RX_LONG,
+    CS_CCC_STREAM,
+    CS_CCC_NB
+};
+
+/* Attribute database buffers, used to exchange data with the stack. The
+ * CCC and RX values are kept per link in app_customss.c. */
 struct app_env_tag_cs
 {
     /* To BLE transfer buffer */
@@ -123,8 +195,46 @@ struct app_env_tag_cs
     /* From BLE long transfer buffer */
     uint8_t from_air_buffer_long[CS_LONG_VALUE_MAX_LENGTH];
     uint8_t from_air_cccd_value_long[2];
+
+    /* Diagnostics buffer */
+    uint8_t diag_buffer[CS_DIAG_VALUE_MAX_LENGTH];
+    uint8_t diag_phase;
+
+    /* Stream buffer */
+    uint8_t stream_buffer[CS_STREAM_VALUE_MAX_LENGTH];
+    uint8_t stream_cccd_value[2];
 };
 
+/* Fill buf with at most max_len bytes for the connection, return the number
+ * of bytes written, 0 ends the stream */
+typedef uint16_t (*cs_stream_source_t)(uint8_t conidx, uint8_t *buf, uint16_t max_len);
+
+/* Per connection stream statistics */
+typedef struct
+{
+    uint32_t bytes;              /* Payload bytes queued to the stack */
+    uint32_t notifications;      /* Notifications acknowledged by the stack */
+    uint32_t errors;             /* Notifications completed with an error */
+    uint32_t stalls;             /* Refills stopped for lack of credits */
+    uint16_t payload;            /* Current notification payload size */
+    uint64_t start;              /* Stream start (RTC cycles) */
+    uint64_t last;               /* Last completion (RTC cycles) */
+} cs_stream_stats_t;
+
+/* Per connection RX long value indication statistics, since connection */
+typedef struct
+{
+    uint32_t queued;             /* Values queued for indication */
+    uint32_t merged;             /* Values superseded before they were sent */
+    uint32_t sent;               /* Indications sent */
+    uint32_t confirmed;          /* Indications confirmed by the peer */
+    uint32_t failed;             /* Indications completed with an error */
+    uint32_t dropped;            /* Values dropped: retries exhausted, CCC disabled or link lost */
+    uint8_t max_depth;           /* Most values pending and in flight at once */
+    uint32_t latency_last;       /* Queue to confirmation, last value (RTC cycles) */
+    uint32_t latency_max;        /* Queue to confirmation, worst value (RTC cycles) */
+} cs_ind_stats_t;
+
 enum custom_app_msg_id
 {
     CUSTOMSS_NTF_TIMEOUT = TASK_FIRST_MSG(TASK_ID_APP) + 60
@@ -143,9 +253,49 @@ void CUSTOMSS_Initialize(void);
 
 void CUSTOMSS_NotifyOnTimeout(uint32_t timeout);
 
+void CUSTOMSS_NotifyPoll(void);
+
+void CUSTOMSS_StreamSetSource(cs_stream_source_t source);
+
+void CUSTOMSS_StreamStart(uint8_t conidx);
+
+void CUSTOMSS_StreamStop(uint8_t conidx);
+
+uint16_t CUSTOMSS_StreamPayloadSize(uint8_t conidx);
+
+const cs_stream_stats_t * CUSTOMSS_StreamGetStats(uint8_t conidx);
+
+uint32_t CUSTOMSS_StreamThroughput(uint8_t conidx);
+
+void CUSTOMSS_StreamLogStats(void);
+
+uint32_t CUSTOMSS_Subscribers(uint8_t ccc, uint8_t value);
+
+void CUSTOMSS_IndicateLong(uint32_t con_mask);
+
+const cs_ind_stats_t * CUSTOMSS_IndGetStats(uint8_t conidx);
+
+void CUSTOMSS_IndLogStats(void);
+
+uint8_t CUSTOMSS_CCCCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                             uint8_t *to, const uint8_t *from,
+                             uint16_t length, uint16_t operation, uint8_t hl_status);
+
+uint8_t CUSTOMSS_StreamCCCCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                   uint8_t *to, const uint8_t *from,
+                                   uint16_t length, uint16_t operation, uint8_t hl_status);
+
 void CUSTOMSS_MsgHandler(ke_msg_id_t const msg_id, void const *param,
                          ke_task_id_t const dest_id, ke_task_id_t const src_id);
 
+uint8_t CUSTOMSS_TXCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                uint8_t *to, const uint8_t *from,
+                                uint16_t length, uint16_t operation, uint8_t hl_status);
+
+uint8_t CUSTOMSS_TXLongCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                    uint8_t *to, const uint8_t *from,
+                                    uint16_t length, uint16_t operation, uint8_t hl_status);
+
 uint8_t CUSTOMSS_RXCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
                                 uint8_t *to, const uint8_t *from,
                                 uint16_t length, uint16_t operation, uint8_t hl_status);
@@ -154,6 +304,10 @@ uint8_t CUSTOMSS_RXLongCharCallback(uint8_t conidx, uint16_t attidx, uint16_t ha
                                     uint8_t *to, const uint8_t *from,
                                     uint16_t length, uint16_t operation, uint8_t hl_status);
 
+uint8_t CUSTOMSS_DiagCharCallback(uint8_t conidx, uint16_t attidx, uint16_t handle,
+                                  uint8_t *to, const uint8_t *from,
+                                  uint16_t length, uint16_t operation, uint8_t hl_status);
+
 /* ----------------------------------------------------------------------------
  * Close the 'extern "C"' block
  * ------------------------------------------------------------------------- */
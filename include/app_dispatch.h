@@ -0,0 +1,109 @@
+/**
+ * @file app_dispatch.h
+ * @brief Application message dispatch header file, delivers each kernel
+ *        message to the handlers registered for its ID and, for completion
+ *        events, its operation
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef APP_DISPATCH_H_
+#define APP_DISPATCH_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Message IDs in the first level table, power of two larger than the
+ * number of IDs registered */
+#define APP_DISPATCH_MSG_NB             64
+
+/* Handlers registered for all message IDs and operations */
+#define APP_DISPATCH_HANDLER_NB         64
+
+/* Operation of a handler that receives every instance of a message */
+#define APP_DISPATCH_ANY_OP             0xFFFF
+
+/* Message IDs with handlers per operation (GAPM_CMP_EVT, GATTC_CMP_EVT,
+ * L2CC_CMP_EVT), each has a table indexed by the 8-bit operation */
+#define APP_DISPATCH_OP_TABLE_NB        3
+#define APP_DISPATCH_OP_NB              256
+
+/* Handler prototype, same as MsgHandler_Add() */
+typedef void (*app_dispatch_handler_t)(ke_msg_id_t const msg_id, void const *param,
+                                       ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Per message ID statistics
+ */
+typedef struct
+{
+    uint32_t count;                         /**< Messages received */
+    uint32_t unhandled;                     /**< Messages with no handler for their operation */
+    uint32_t cycles;                        /**< Core clock cycles spent in handlers */
+    uint32_t max_cycles;                    /**< Longest handling (core clock cycles) */
+} app_dispatch_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Register a handler for every instance of a message.
+ *
+ * @param[in] msg_id  Kernel message ID
+ * @param[in] handler Handler
+ */
+void AppDispatch_Add(ke_msg_id_t msg_id, app_dispatch_handler_t handler);
+
+/**
+ * @brief Register a handler for the completion of one operation. The first
+ *        byte of the message parameters is the operation (GAPM_CMP_EVT,
+ *        GAPC_CMP_EVT, GATTC_CMP_EVT). Handlers of every instance of the
+ *        message run before the handlers of the operation.
+ *
+ * @param[in] msg_id    Kernel message ID
+ * @param[in] operation Operation the handler owns
+ * @param[in] handler   Handler
+ */
+void AppDispatch_Add_Op(ke_msg_id_t msg_id, uint16_t operation, app_dispatch_handler_t handler);
+
+/**
+ * @brief Log the statistics of all message IDs through the deferred trace
+ *        log, called by the statistics report
+ */
+void AppDispatch_Log(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* APP_DISPATCH_H_ */
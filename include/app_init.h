@@ -30,6 +30,8 @@ void DeviceInit(void);
 
 void AppMsgHandlersInit(void);
 
+void AppStatsReportInit(void);
+
 void CustomServiceServerInit(void);
 
 void IRQPriorityInit(void);
@@ -50,7 +52,9 @@ uint32_t Power_Down_FPU(void);
 
 uint32_t Power_Down_Debug(void);
 
-void Init_SWMTrace(void);
+void Power_Up_FPU(void);
+
+void Power_Up_Debug(void);
 
 void Print_Time_Info(uint64_t total_rtc_cycles);
 
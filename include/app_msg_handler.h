@@ -44,6 +44,8 @@ void BLE_PairingHandler(ke_msg_id_t const msg_id, void const *param,
                         ke_task_id_t const dest_id,
                         ke_task_id_t const src_id);
 
+extern bool ble_adv_enable;
+
 void PrepareAdvScanData(void);
 
 void ControlBLEAdvActivity(bool adv_enable);
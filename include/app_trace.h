@@ -0,0 +1,218 @@
+/**
+ * @file app_trace.h
+ * @brief Application trace header file, initializes swmTrace on first use
+ *        after a wakeup instead of on every wakeup
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef APP_TRACE_H_
+#define APP_TRACE_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <swmTrace_api.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* UART transmitter still shifting out data */
+#define TRACE_UART_TX_BUSY()            ((UART->SR & UART_TX_BUSY) == UART_TX_BUSY)
+
+/* UART transmit interrupt, swmTrace sends the next character of its TX
+ * buffer from it */
+#define TRACE_UART_TX_IRQn              UART0_TX_IRQn
+#define TRACE_UART_TX_IRQ_PENDING()     (NVIC_GetEnableIRQ(TRACE_UART_TX_IRQn) && \
+                                         NVIC_GetPendingIRQ(TRACE_UART_TX_IRQn))
+
+/* Upper bound for Trace_Flush() in RTC cycles, time to send the whole
+ * swmTrace TX buffer at UART_BAUD (10 bits per character) plus one cycle
+ * of RTC resolution */
+#define TRACE_FLUSH_TIMEOUT_CYCLES      ((uint32_t)(256 * 10 * 32768ULL / UART_BAUD) + 1)
+
+/* Log levels, a log is compiled in if its level is at most the level of its
+ * module and sent if its bit is set in the runtime level mask */
+#define APP_LOG_LEVEL_NONE              0
+#define APP_LOG_LEVEL_ERROR             1
+#define APP_LOG_LEVEL_WARN              2
+#define APP_LOG_LEVEL_INFO              3
+#define APP_LOG_LEVEL_DEBUG             4
+
+/* Release and Release_Light define APP_LOG_RELEASE, only errors are
+ * compiled in */
+#ifndef APP_LOG_LEVEL_DEFAULT
+#if defined (APP_LOG_RELEASE)
+#define APP_LOG_LEVEL_DEFAULT           APP_LOG_LEVEL_ERROR
+#else    /* if defined (APP_LOG_RELEASE) */
+#define APP_LOG_LEVEL_DEFAULT           APP_LOG_LEVEL_INFO
+#endif    /* if defined (APP_LOG_RELEASE) */
+#endif    /* ifndef APP_LOG_LEVEL_DEFAULT */
+
+/* Highest level compiled in per module. A source file selects its module by
+ * defining APP_LOG_MODULE before its includes, APP if it does not.
+ *   - APP:       main loop, battery service, wakeup time
+ *   - BLE:       BLE stack events, connection policy, L2CAP offload
+ *   - CUSTOMSS:  custom service callbacks and streams
+ *   - SCHEDULER: sleep durations computed by the scheduler
+ *   - DIAG:      dumps decoded by tools/, each has its own period define */
+#ifndef APP_LOG_LEVEL_APP
+#define APP_LOG_LEVEL_APP               APP_LOG_LEVEL_DEFAULT
+#endif    /* ifndef APP_LOG_LEVEL_APP */
+
+#ifndef APP_LOG_LEVEL_BLE
+#define APP_LOG_LEVEL_BLE               APP_LOG_LEVEL_DEFAULT
+#endif    /* ifndef APP_LOG_LEVEL_BLE */
+
+#ifndef APP_LOG_LEVEL_CUSTOMSS
+#define APP_LOG_LEVEL_CUSTOMSS          APP_LOG_LEVEL_DEFAULT
+#endif    /* ifndef APP_LOG_LEVEL_CUSTOMSS */
+
+#ifndef APP_LOG_LEVEL_SCHEDULER
+#define APP_LOG_LEVEL_SCHEDULER         APP_LOG_LEVEL_DEFAULT
+#endif    /* ifndef APP_LOG_LEVEL_SCHEDULER */
+
+/* Dumps are for development captures, release builds have none */
+#ifndef APP_LOG_LEVEL_DIAG
+#if defined (APP_LOG_RELEASE)
+#define APP_LOG_LEVEL_DIAG              APP_LOG_LEVEL_NONE
+#else    /* if defined (APP_LOG_RELEASE) */
+#define APP_LOG_LEVEL_DIAG              APP_LOG_LEVEL_INFO
+#endif    /* if defined (APP_LOG_RELEASE) */
+#endif    /* ifndef APP_LOG_LEVEL_DIAG */
+
+#ifndef APP_LOG_MODULE
+#define APP_LOG_MODULE                  APP
+#endif    /* ifndef APP_LOG_MODULE */
+
+/* Runtime level mask bits, all levels are enabled at reset */
+#define APP_LOG_MASK(level)             (1U << (level))
+#define APP_LOG_MASK_ALL                (APP_LOG_MASK(APP_LOG_LEVEL_ERROR) | \
+                                         APP_LOG_MASK(APP_LOG_LEVEL_WARN) |  \
+                                         APP_LOG_MASK(APP_LOG_LEVEL_INFO) |  \
+                                         APP_LOG_MASK(APP_LOG_LEVEL_DEBUG))
+
+#define APP_LOG_CAT_(a, b)              a ## b
+#define APP_LOG_CAT(a, b)               APP_LOG_CAT_(a, b)
+
+/* true if a log of this level is compiled in for the current module and
+ * enabled at runtime. The first test is a constant, a disabled level costs
+ * nothing, not even the evaluation of the arguments. */
+#define APP_LOG_ON(level)                                               \
+    (((level) <= APP_LOG_CAT(APP_LOG_LEVEL_, APP_LOG_MODULE)) &&        \
+     (trace_level_mask & APP_LOG_MASK(level)))
+
+/* Log through the application trace, swmTrace is initialized on the first
+ * log after a wakeup. While the DMA sends deferred records the text is
+ * queued behind them in the ring instead, see trace_log.h.
+ * Use these instead of swmLogInfo()/swmLogError(). */
+#define APP_LOG(level, log, ...)        \
+    do                                  \
+    {                                   \
+        if (APP_LOG_ON(level))          \
+        {                               \
+            if (Trace_Acquire())        \
+            {                           \
+                log(__VA_ARGS__);       \
+                Trace_Release();        \
+            }                           \
+            else                        \
+            {                           \
+                TraceLog_Text(__VA_ARGS__); \
+            }                           \
+        }                               \
+    } while (0)
+
+#define APP_LOG_ERROR(...)              APP_LOG(APP_LOG_LEVEL_ERROR, swmLogError, __VA_ARGS__)
+#define APP_LOG_WARN(...)               APP_LOG(APP_LOG_LEVEL_WARN, swmLogInfo, __VA_ARGS__)
+#define APP_LOG_INFO(...)               APP_LOG(APP_LOG_LEVEL_INFO, swmLogInfo, __VA_ARGS__)
+#define APP_LOG_DEBUG(...)              APP_LOG(APP_LOG_LEVEL_DEBUG, swmLogInfo, __VA_ARGS__)
+
+/* Runtime level mask, APP_LOG_MASK() bits */
+extern uint8_t trace_level_mask;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize swmTrace if it was not used since the last wakeup,
+ *        without taking a reference.
+ */
+void Trace_Open(void);
+
+/**
+ * @brief Take a reference on the trace interface, initializing swmTrace if
+ *        it was not used since the last wakeup. Does not wait for the DMA.
+ *
+ * @return true if the reference was taken, false while the DMA sends
+ *         deferred records: the UART is not available for text
+ */
+bool Trace_Acquire(void);
+
+/**
+ * @brief Release a reference taken with Trace_Acquire().
+ */
+void Trace_Release(void);
+
+/**
+ * @brief Check if swmTrace text was logged since the last Trace_Flush().
+ *
+ * @return true if text may still be in the swmTrace buffer
+ */
+bool Trace_Pending(void);
+
+/**
+ * @brief Mark the trace interface as lost. Called after waking up from
+ *        sleep, the UART is re-initialized on the next Trace_Acquire().
+ */
+void Trace_Invalidate(void);
+
+/**
+ * @brief Select the log levels sent at runtime. Levels compiled out by the
+ *        module levels stay disabled.
+ *
+ * @param[in] mask APP_LOG_MASK() bits of the enabled levels
+ */
+void Trace_Set_Level_Mask(uint8_t mask);
+
+/**
+ * @brief Wait until all logs are sent on the UART, the swmTrace software
+ *        buffer first and then the UART transmitter. Logs stay pending if
+ *        a user still holds the trace.
+ *
+ * @note Must be called with interrupts enabled, the swmTrace non-blocking
+ *       transmit buffer is drained from the UART interrupt.
+ */
+void Trace_Flush(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* APP_TRACE_H_ */
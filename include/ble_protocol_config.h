@@ -41,15 +41,30 @@ extern "C"
 /* Heap memory size used by kernel and BLE stack */
 #define APP_HEAP_SIZE_DEFINED           1
 
-/* Maximum number of connection */
+/* Maximum number of connection, up to BLE_CONNECTION_MAX (10). The custom
+ * service and the notification queues keep their per link state in tables
+ * of this size. */
 #define APP_MAX_NB_CON                  3
 
+/* Set this to 1 to broadcast sensor records in extended and periodic
+ * advertising next to the connectable advertising, see broadcast.h */
+#if defined (CFG_REDUCED_DRAM)
+#define APP_BROADCAST_ENABLE            0
+#else    /* if defined (CFG_REDUCED_DRAM) */
+#define APP_BROADCAST_ENABLE            1
+#endif    /* if defined (CFG_REDUCED_DRAM) */
+
 /* Maximum number of activities */
-#define APP_MAX_NB_ACTIVITY             1
+#define APP_MAX_NB_ACTIVITY             (1 + APP_BROADCAST_ENABLE)
 
 /* Maximum number of profiles */
 #define APP_MAX_NB_PROFILES             8
 
+/* Set this to 1 to size the heaps from include/ble_heap_profile.h, generated
+ * by tools/heap_profile.py from the peaks dumped by heap_profile.c, instead
+ * of the formulas below */
+#define APP_HEAP_PROFILE_SIZES          0
+
 /* Size of environment variables in heap memory */
 #define APP_RWIP_HEAP_ENV_SIZE          (600 + (APP_MAX_NB_ACTIVITY) * 230) + \
     APP_MAX_NB_CON * ((sizeof(struct gapc_env_tag)  + KE_HEAP_MEM_RESERVED)    \
@@ -57,8 +72,39 @@ extern "C"
                       + (sizeof(struct l2cc_env_tag)   + KE_HEAP_MEM_RESERVED))  \
     + ((APP_MAX_NB_ACTIVITY)*(sizeof(struct gapm_actv_scan_tag) + KE_HEAP_MEM_RESERVED))
 
+/* Custom service streaming: ATT MTU and LE data length requested when a
+ * stream starts, and number of stream notifications in flight (shared by
+ * all connections, each one holds a message in the heap) */
+#define APP_STREAM_MTU                  247
+#define APP_STREAM_TX_OCTETS            251
+#define APP_STREAM_TX_TIME              2120
+#if defined (CFG_REDUCED_DRAM)
+#define APP_STREAM_CREDITS              2
+#else    /* if defined (CFG_REDUCED_DRAM) */
+#define APP_STREAM_CREDITS              6
+#endif    /* if defined (CFG_REDUCED_DRAM) */
+
+/* Kernel message header and heap block overhead of one notification */
+#define APP_STREAM_MSG_OVERHEAD         (sizeof(struct ke_msg) + KE_HEAP_MEM_RESERVED + 16)
+
+/* Set this to 1 to upload records over an LE credit based channel, see
+ * l2cap_offload.h. The SDUs in flight take about 3 KB of message heap. */
+#if defined (CFG_REDUCED_DRAM)
+#define APP_L2CAP_OFFLOAD_ENABLE        0
+#else    /* if defined (CFG_REDUCED_DRAM) */
+#define APP_L2CAP_OFFLOAD_ENABLE        1
+#endif    /* if defined (CFG_REDUCED_DRAM) */
+
+/* LE credit based channels: one per connection, K-frame payload (MPS)
+ * filling one LL PDU of APP_STREAM_TX_OCTETS, largest SDU sent and number
+ * of SDUs in flight on each channel (each one holds a message in the heap) */
+#define APP_LECB_NB                     (APP_L2CAP_OFFLOAD_ENABLE * APP_MAX_NB_CON)
+#define APP_LECB_MPS                    (APP_STREAM_TX_OCTETS - 4)
+#define APP_LECB_SDU_MAX                (2 * APP_LECB_MPS - 2)
+#define APP_LECB_SDU_IN_FLIGHT          2
+
 /* Size of data base memory in heap */
-#define APP_RWIP_HEAP_DB_SIZE           (768)
+#define APP_RWIP_HEAP_DB_SIZE           (896)
 
 /* Size of message heap memory */
 #define APP_RWIP_HEAP_MSG_SIZE          (1650 + 2 * \
@@ -66,12 +112,30 @@ extern "C"
                                           (58 + (APP_MAX_NB_ACTIVITY - 1) * 26) + ((APP_MAX_NB_ACTIVITY) * 66) + \
                                           ((APP_MAX_NB_ACTIVITY) * 100) + ((APP_MAX_NB_ACTIVITY) * 12))) + \
     (((BLEHL_HEAP_MSG_SIZE_PER_CON * APP_MAX_NB_CON) > BLEHL_HEAP_DATA_THP_SIZE) \
-     ? (BLEHL_HEAP_MSG_SIZE_PER_CON * APP_MAX_NB_CON) : BLEHL_HEAP_DATA_THP_SIZE) \
+     ? (BLEHL_HEAP_MSG_SIZE_PER_CON * APP_MAX_NB_CON) : BLEHL_HEAP_DATA_THP_SIZE) + \
+    (APP_STREAM_CREDITS * (APP_STREAM_MTU + APP_STREAM_MSG_OVERHEAD)) + \
+    (APP_BROADCAST_ENABLE * 2 * (BROADCAST_ADV_DATA_LEN + APP_STREAM_MSG_OVERHEAD)) + \
+    ((NTF_QUEUE_POOL_SIZE + APP_MAX_NB_CON * NTF_QUEUE_IN_FLIGHT) * \
+     (NTF_QUEUE_BUF_SIZE + APP_STREAM_MSG_OVERHEAD)) + \
+    (APP_LECB_NB * APP_LECB_SDU_IN_FLIGHT * (APP_LECB_SDU_MAX + APP_STREAM_MSG_OVERHEAD))
 
 
 /* Non retention memory in heap for security algorithm calculations */
 #define APP_RWIP_HEAP_NON_RET_SIZE      (328 * 2)
 
+#if (APP_HEAP_PROFILE_SIZES == 1)
+#include "ble_heap_profile.h"
+
+#undef APP_RWIP_HEAP_ENV_SIZE
+#undef APP_RWIP_HEAP_DB_SIZE
+#undef APP_RWIP_HEAP_MSG_SIZE
+#undef APP_RWIP_HEAP_NON_RET_SIZE
+#define APP_RWIP_HEAP_ENV_SIZE          APP_HEAP_PROFILE_ENV_SIZE
+#define APP_RWIP_HEAP_DB_SIZE           APP_HEAP_PROFILE_DB_SIZE
+#define APP_RWIP_HEAP_MSG_SIZE          APP_HEAP_PROFILE_MSG_SIZE
+#define APP_RWIP_HEAP_NON_RET_SIZE      APP_HEAP_PROFILE_NON_RET_SIZE
+#endif    /* if (APP_HEAP_PROFILE_SIZES == 1) */
+
 /* Provide seed for random number from application */
 #define APP_BLE_RAND_SEED_DEFINED       0
 
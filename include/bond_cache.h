@@ -0,0 +1,132 @@
+/**
+ * @file bond_cache.h
+ * @brief Bond cache header file, keeps the IRKs of the bond list, the
+ *        recently resolved private addresses and the bonds not written to
+ *        flash yet in RAM
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef BOND_CACHE_H_
+#define BOND_CACHE_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Resolvable private addresses remembered with the IRK that resolved them */
+#define BOND_CACHE_RPA_NB               8
+
+/* Bonds kept in RAM until the next flush. They are written together when a
+ * link is released or when this many are pending, a reset before that
+ * loses them and the peers pair again. */
+#define BOND_CACHE_PENDING_NB           4
+
+/**
+ * @brief Bond cache statistics
+ */
+typedef struct
+{
+    uint32_t rpa_hits;                      /**< Connections confirmed from the RPA map */
+    uint32_t rpa_misses;                    /**< Resolutions run with the cached IRKs */
+    uint32_t bonds_written;                 /**< Bonds written to flash */
+    uint32_t flushes;                       /**< Batches of pending bonds written */
+} bond_cache_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Load the IRKs of the bond list in RAM.
+ */
+void BondCache_Init(void);
+
+/**
+ * @brief Resolve the private address of a connecting peer. A recently seen
+ *        address is resolved at once, otherwise the stack resolves it with
+ *        the cached IRKs and ends with GAPM_ADDR_SOLVED_IND or
+ *        GAPM_CMP_EVT / GAPM_RESOLV_ADDR, as GAPM_ResolvAddrCmd() does.
+ *
+ * @param[in] conidx Connection index
+ * @param[in] addr   Peer resolvable private address
+ *
+ * @return true if the address was resolved from the cache, the caller
+ *         confirms the connection
+ */
+bool BondCache_Resolve(uint8_t conidx, const uint8_t *addr);
+
+/**
+ * @brief Copy the keys of a link in RAM when pairing completes. They are
+ *        written to flash with the next BondCache_Flush().
+ *
+ * @param[in] conidx Connection index
+ */
+void BondCache_Add(uint8_t conidx);
+
+/**
+ * @brief Write the pending bonds to flash and reload the IRKs.
+ */
+void BondCache_Flush(void);
+
+/**
+ * @brief Number of bonds, written or pending
+ *
+ * @return Bonds in the bond list and in RAM
+ */
+uint8_t BondCache_Size(void);
+
+/**
+ * @brief Learn resolved addresses, flush the pending bonds when a link is
+ *        released.
+ */
+void BondCache_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                          ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read bond cache statistics
+ *
+ * @return Pointer to statistics
+ */
+const bond_cache_stats_t * BondCache_Get_Stats(void);
+
+/**
+ * @brief Log the address resolutions and bond list writes, one section of
+ *        the statistics report
+ */
+void BondCache_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* BOND_CACHE_H_ */
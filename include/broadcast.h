@@ -0,0 +1,142 @@
+/**
+ * @file broadcast.h
+ * @brief Broadcast header file, sends sensor records in extended and
+ *        periodic advertising next to the connectable advertising set
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef BROADCAST_H_
+#define BROADCAST_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Period of the broadcast task, a record is added and broadcast each run */
+#define BROADCAST_PERIOD_S              10
+
+/* Broadcast duration after each update (units of 10ms) */
+#define BROADCAST_DURATION              300
+
+/* Extended advertising interval (units of 625us) and periodic advertising
+ * interval (units of 1.25ms) */
+#define BROADCAST_ADV_INT               1600
+#define BROADCAST_PER_ADV_INT           800
+
+/* Advertising set ID of the broadcast */
+#define BROADCAST_ADV_SID               1
+
+/* Application task instance the broadcast set is created from, its
+ * GAPM_ACTIVITY_CREATED_IND is told apart from the one of the connectable
+ * set, created from instance 0 by GAPM_ActivityCreateAdvCmd() */
+#define BROADCAST_TASK_IDX              1
+
+/* Advertising data size: one manufacturer specific AD structure holding the
+ * company ID and the records */
+#define BROADCAST_ADV_DATA_LEN          255
+
+/**
+ * @brief Sensor record added by the broadcast task
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t seq;                           /**< Record sequence number */
+    uint32_t time_s;                        /**< Time since reset (s) */
+    uint8_t battery;                        /**< Battery level (%) */
+} broadcast_record_t;
+
+/* Whole records that fit in the advertising data */
+#define BROADCAST_RECORDS_NB            ((BROADCAST_ADV_DATA_LEN - 2 - APP_COMPANY_ID_LEN) / \
+                                         sizeof(broadcast_record_t))
+
+/**
+ * @brief Broadcast statistics
+ */
+typedef struct
+{
+    uint32_t records;                       /**< Records added */
+    uint32_t dropped;                       /**< Oldest records dropped for space */
+    uint32_t updates;                       /**< Data updates sent */
+    uint32_t errors;                        /**< Commands rejected by the stack */
+} broadcast_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Add a record to the broadcast data. The oldest record is dropped
+ *        when the data is full.
+ *
+ * @param[in] rec Record
+ */
+void Broadcast_Add_Record(const broadcast_record_t *rec);
+
+/**
+ * @brief Broadcast the records. Creates the advertising set on first use.
+ */
+void Broadcast_Update(void);
+
+/**
+ * @brief Check if an activity is the broadcast set.
+ *
+ * @param[in] actv_idx Activity index
+ *
+ * @return true for the broadcast set
+ */
+bool Broadcast_Owns(uint8_t actv_idx);
+
+/**
+ * @brief Follow the broadcast set creation, data updates and stop.
+ */
+void Broadcast_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                          ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read broadcast statistics
+ *
+ * @return Pointer to statistics
+ */
+const broadcast_stats_t * Broadcast_Get_Stats(void);
+
+/**
+ * @brief Log the broadcast records and data updates, one section of the
+ *        statistics report
+ */
+void Broadcast_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* BROADCAST_H_ */
@@ -0,0 +1,144 @@
+/**
+ * @file clock_manager.h
+ * @brief System clock manager header file, runs the system clock at the
+ *        highest level requested by its users
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef CLOCK_MANAGER_H_
+#define CLOCK_MANAGER_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Set this to 0 to keep the system clock at SYSTEM_CLK */
+#define CLOCK_SCALING_ENABLE            1
+
+/* Level requested while the BLE kernel has events to process */
+#define CLOCK_BLE_LEVEL                 CLOCK_LEVEL_16MHZ
+
+/* Baseband clock, SYSTEM_CLK / 8 as set by DeviceInit() */
+#define CLOCK_BBCLK_FREQ                1000000
+
+/* Baseband clock divider for a system clock, written with every change */
+#define CLOCK_BBCLK_DIVIDER(freq)       ((((freq) / CLOCK_BBCLK_FREQ) - 1) << BBIF_CTRL_BBCLK_DIVIDER_Pos)
+
+/**
+ * @brief System clock levels, derived from the 48 MHz XTAL.
+ *        8 MHz is the lowest level and runs light wakeups: the XTAL
+ *        prescaler divides by 7 at most, and 48/7 MHz cannot give UART_CLK
+ *        or CLOCK_BBCLK_FREQ.
+ */
+typedef enum
+{
+    CLOCK_LEVEL_8MHZ = 0,                   /**< SYSTEM_CLK, restored after sleep */
+    CLOCK_LEVEL_16MHZ,
+    CLOCK_LEVEL_24MHZ,
+    CLOCK_LEVEL_48MHZ,
+    CLOCK_LEVEL_NB
+} clock_level_t;
+
+#define CLOCK_LEVEL_LOW                 CLOCK_LEVEL_8MHZ
+
+/**
+ * @brief Users that can request a clock level
+ */
+typedef enum
+{
+    CLOCK_USER_TASK = 0,                    /**< Running scheduler task */
+    CLOCK_USER_BLE,                         /**< BLE kernel processing */
+    CLOCK_USER_NB
+} clock_user_t;
+
+/**
+ * @brief Clock manager statistics
+ */
+typedef struct
+{
+    uint32_t switches;                      /**< Number of system clock changes */
+    uint32_t requests[CLOCK_LEVEL_NB];      /**< Requests per level */
+    uint32_t denied;                        /**< Raises refused, the trace DMA was active */
+} clock_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Request a clock level for a user. The clock is raised to the
+ *        highest level requested by all users, and is only lowered by
+ *        Clock_Idle() or sleep.
+ *
+ * @param[in] user  Requesting user
+ * @param[in] level Required level, CLOCK_LEVEL_LOW when done
+ */
+void Clock_Request(clock_user_t user, clock_level_t level);
+
+/**
+ * @brief Lower the clock to the highest level still requested. Called from
+ *        the main loop before and after the BLE kernel processing, so the
+ *        clock changes at most twice per wakeup.
+ */
+void Clock_Idle(void);
+
+/**
+ * @brief Current clock level
+ *
+ * @return Current level
+ */
+clock_level_t Clock_Get_Level(void);
+
+/**
+ * @brief Called after sleep, the wakeup restores SYSTEM_CLK and drops all
+ *        requests.
+ */
+void Clock_Sleep_Exit(void);
+
+/**
+ * @brief Read clock manager statistics
+ *
+ * @return Pointer to statistics
+ */
+const clock_stats_t * Clock_Get_Stats(void);
+
+/**
+ * @brief Log the clock changes and the requests per level, one section of
+ *        the statistics report
+ */
+void Clock_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* CLOCK_MANAGER_H_ */
@@ -0,0 +1,134 @@
+/**
+ * @file conn_policy.h
+ * @brief Connection parameter policy header file, requests a short interval
+ *        during bulk transfers and a long interval with slave latency when
+ *        idle, and filters peer requests that would cost too much power
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef CONN_POLICY_H_
+#define CONN_POLICY_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Bulk transfer parameters: 7.5 ms to 15 ms, no latency
+ * (interval in units of 1.25 ms, supervision timeout in units of 10 ms) */
+#define CONN_POLICY_BULK_INTV_MIN       6
+#define CONN_POLICY_BULK_INTV_MAX       12
+#define CONN_POLICY_BULK_LATENCY        0
+#define CONN_POLICY_BULK_SUP_TIMEOUT    200
+
+/* Idle parameters: 500 ms to 600 ms, 4 events of latency. The supervision
+ * timeout must exceed (1 + latency) * interval * 2 */
+#define CONN_POLICY_IDLE_INTV_MIN       400
+#define CONN_POLICY_IDLE_INTV_MAX       480
+#define CONN_POLICY_IDLE_LATENCY        4
+#define CONN_POLICY_IDLE_SUP_TIMEOUT    700
+
+/* Time left at the connection parameters of the central after connecting
+ * or after a bulk transfer, before the idle parameters are requested
+ * (service discovery and pairing run in this window) (units of 1ms) */
+#define CONN_POLICY_IDLE_DELAY_MS       5000
+
+/* Peer requests are rejected while idle if the peripheral would have to
+ * listen more often than this (interval * (1 + latency), units of 1.25ms) */
+#define CONN_POLICY_PEER_MIN_PERIOD     80
+
+/* Consecutive rejections per link, the next request is accepted so peers
+ * that insist are not disconnected */
+#define CONN_POLICY_MAX_REJECTS         2
+
+/* Time-at-interval buckets, upper bounds in units of 1.25 ms */
+#define CONN_POLICY_BUCKET_BOUNDS       { 12, 24, 40, 80, 200, 400, 800 }
+#define CONN_POLICY_BUCKET_NB           8
+
+/**
+ * @brief Connection parameter policy statistics
+ */
+typedef struct
+{
+    uint32_t peer_requests;                 /**< Parameter update requests from peers */
+    uint32_t peer_rejected;                 /**< Peer requests rejected */
+    uint32_t own_requests;                  /**< Parameter updates requested by the policy */
+    uint32_t updates;                       /**< Parameter changes applied on any link */
+    uint64_t time_at_interval[CONN_POLICY_BUCKET_NB];   /**< Link time per interval bucket (RTC cycles) */
+} conn_policy_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Switch a link between bulk and idle parameters. Bulk parameters are
+ *        requested at once, idle ones CONN_POLICY_IDLE_DELAY_MS later.
+ *
+ * @param[in] conidx Connection index
+ * @param[in] bulk   true when a bulk transfer starts, false when it ends
+ */
+void ConnPolicy_Set_Bulk(uint8_t conidx, bool bulk);
+
+/**
+ * @brief Accept or reject a peer parameter update request.
+ *
+ * @param[in] conidx Connection index
+ * @param[in] param  GAPC_PARAM_UPDATE_REQ_IND parameters
+ */
+void ConnPolicy_Param_Update_Req(uint8_t conidx, const void *param);
+
+/**
+ * @brief Track connection parameters and run the idle timer.
+ */
+void ConnPolicy_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                           ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read connection parameter policy statistics, time at interval
+ *        includes the current parameters of active links
+ *
+ * @return Pointer to statistics
+ */
+const conn_policy_stats_t * ConnPolicy_Get_Stats(void);
+
+/**
+ * @brief Log the parameter requests and the link time per interval bucket,
+ *        one section of the statistics report
+ */
+void ConnPolicy_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* CONN_POLICY_H_ */
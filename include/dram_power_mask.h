@@ -0,0 +1,40 @@
+/**
+ * @file dram_power_mask.h
+ * @brief DRAM instances kept powered in sleep for CFG_REDUCED_DRAM builds
+ *
+ * Generated by tools/dram_bank_mask.py from the linker map, do not edit.
+ * Re-generate after changing the DRAM layout or the retained data:
+ *     python tools/dram_bank_mask.py <project>.map include/dram_power_mask.h
+ *
+ *   DRAM0: retained
+ *   DRAM1: retained
+ *   DRAM2: retained
+ *   DRAM3: retained (._stack)
+ *   DRAM4: gated
+ *   DRAM5: gated
+ *   DRAM6: gated
+ *   DRAM7: gated
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef DRAM_POWER_MASK_H_
+#define DRAM_POWER_MASK_H_
+
+/* Number of DRAM instances holding retained data */
+#define DRAM_RETAINED_BANK_COUNT        4
+
+/* DRAM_POWER_BYTE value enabling only the retained DRAM instances */
+#define DRAM_RETAINED_POWER_MASK        (DRAM0_POWER_ENABLE_BYTE | DRAM1_POWER_ENABLE_BYTE | DRAM2_POWER_ENABLE_BYTE | DRAM3_POWER_ENABLE_BYTE)
+
+#endif    /* DRAM_POWER_MASK_H_ */
@@ -0,0 +1,96 @@
+/**
+ * @file heap_profile.h
+ * @brief BLE heap profile header file, reports the peak usage of each
+ *        kernel heap for right-sizing them
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef HEAP_PROFILE_H_
+#define HEAP_PROFILE_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Dump the heap peaks through the trace every this many RTC wakeups,
+ * 0 disables the dump. Turn them into heap sizes with
+ * tools/heap_profile.py, see APP_HEAP_PROFILE_SIZES */
+#define HEAP_PROFILE_LOG_PERIOD         100
+
+/**
+ * @brief Kernel heaps, in the order of the kernel memory types
+ */
+typedef enum
+{
+    HEAP_PROFILE_ENV = 0,                   /**< Environment heap */
+    HEAP_PROFILE_DB,                        /**< Attribute database heap */
+    HEAP_PROFILE_MSG,                       /**< Kernel message heap */
+    HEAP_PROFILE_NON_RET,                   /**< Non retained heap */
+    HEAP_PROFILE_NB
+} heap_profile_heap_t;
+
+/**
+ * @brief Size and peak usage of the kernel heaps
+ */
+typedef struct
+{
+    uint16_t size[HEAP_PROFILE_NB];         /**< Configured size (bytes) */
+    uint16_t peak[HEAP_PROFILE_NB];         /**< Peak usage since reset (bytes) */
+    uint8_t max_con;                        /**< Most connections open at once */
+} heap_profile_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Read the peak usage of the heaps from the kernel.
+ *
+ * @return Pointer to the heap profile
+ */
+const heap_profile_t * HeapProfile_Get(void);
+
+/**
+ * @brief Dump the heap profile through the trace as
+ *        HEAPPROF <max_con> <size> <peak> for env, db, msg and non_ret
+ */
+void HeapProfile_Dump(void);
+
+/**
+ * @brief Dump the heap profile every HEAP_PROFILE_LOG_PERIOD calls.
+ */
+void HeapProfile_Dump_Periodic(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* HEAP_PROFILE_H_ */
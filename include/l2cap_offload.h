@@ -0,0 +1,124 @@
+/**
+ * @file l2cap_offload.h
+ * @brief L2CAP offload header file, uploads stored records to a peer over an
+ *        LE credit based connection oriented channel
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef L2CAP_OFFLOAD_H_
+#define L2CAP_OFFLOAD_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* LE protocol/service multiplexer of the offload channel (dynamic range) */
+#define L2CAP_OFFLOAD_PSM               0x0081
+
+/* Credits given to the peer for its requests, one is returned per request */
+#define L2CAP_OFFLOAD_RX_CREDITS        2
+
+/* Requests from the peer:
+ *   START: 1 byte opcode, 4 bytes offset (little endian). The offset
+ *          L2CAP_OFFLOAD_RESUME continues after the last SDU sent on the
+ *          link, also on a new channel. Ignored during an upload.
+ *   STOP:  1 byte opcode
+ * Each SDU to the peer starts with the 4 bytes offset of its data. */
+#define L2CAP_OFFLOAD_OP_START          0x01
+#define L2CAP_OFFLOAD_OP_STOP           0x02
+#define L2CAP_OFFLOAD_RESUME            0xFFFFFFFF
+#define L2CAP_OFFLOAD_HDR_LEN           4
+
+/* Size of the built-in test records */
+#define L2CAP_OFFLOAD_TEST_LENGTH       (64 * 1024)
+
+/**
+ * @brief Record source, copies up to max_len bytes from offset into buf
+ *        and returns the number of bytes copied, 0 at the end of the records.
+ */
+typedef uint16_t (*l2cap_offload_source_t)(uint32_t offset, uint8_t *buf, uint16_t max_len);
+
+/**
+ * @brief Offload statistics
+ */
+typedef struct
+{
+    uint32_t channels;                      /**< Channels accepted */
+    uint32_t sdus;                          /**< SDUs sent */
+    uint32_t frames;                        /**< K-frames sent, one credit each */
+    uint32_t bytes;                         /**< Record bytes sent */
+    uint32_t credit_stalls;                 /**< Sends held back for peer credits */
+    uint32_t resumes;                       /**< Uploads started at a non-zero offset */
+    uint32_t rejected;                      /**< START requests received during an upload */
+} l2cap_offload_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Register the offload LE_PSM. Called once the device is configured.
+ */
+void L2capOffload_Init(void);
+
+/**
+ * @brief Set the function providing the records. NULL selects the built-in
+ *        test records.
+ *
+ * @param[in] source Record source
+ */
+void L2capOffload_SetSource(l2cap_offload_source_t source);
+
+/**
+ * @brief Follow the channels, peer requests and credits.
+ */
+void L2capOffload_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                             ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read offload statistics
+ *
+ * @return Pointer to statistics
+ */
+const l2cap_offload_stats_t * L2capOffload_Get_Stats(void);
+
+/**
+ * @brief Log the record uploads, one section of the statistics report
+ */
+void L2capOffload_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* L2CAP_OFFLOAD_H_ */
@@ -0,0 +1,157 @@
+/**
+ * @file ntf_queue.h
+ * @brief Notification queue header file, per connection queues of
+ *        notifications and indications backed by a pool of reference
+ *        counted GATTC_SEND_EVT_CMD messages filled in place
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef NTF_QUEUE_H_
+#define NTF_QUEUE_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Messages in the pool and payload size of each one (bytes) */
+#define NTF_QUEUE_POOL_SIZE             8
+#define NTF_QUEUE_BUF_SIZE              40
+
+/* Entries of each connection queue */
+#define NTF_QUEUE_DEPTH                 8
+
+/* Notifications handed to the stack and not completed yet, per connection */
+#define NTF_QUEUE_IN_FLIGHT             2
+
+/* Sequence number tagging queued notifications in GATTC_CMP_EVT */
+#define NTF_QUEUE_SEQ_NUM               0x5A5B
+
+/* Subscriber mask bit of a connection */
+#define NTF_QUEUE_CON(conidx)           (1UL << (conidx))
+
+/**
+ * @brief Per connection queue statistics
+ */
+typedef struct
+{
+    uint32_t queued;                        /**< Entries added to the queue */
+    uint32_t sent;                          /**< Entries completed by the stack */
+    uint32_t drops;                         /**< Entries dropped, queue full */
+    uint8_t high_watermark;                 /**< Highest number of queued entries */
+} ntf_queue_stats_t;
+
+/**
+ * @brief Buffer pool statistics
+ */
+typedef struct
+{
+    uint32_t allocs;                        /**< Buffers allocated */
+    uint32_t exhausted;                     /**< Allocations failed, pool empty */
+    uint32_t copies;                        /**< Payloads copied for one more subscriber */
+    uint8_t high_watermark;                 /**< Highest number of buffers in use */
+} ntf_queue_pool_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Allocate the pool messages, initialize the queues and subscribe to
+ *        the events completing queued notifications. Called once the BLE
+ *        kernel is initialized.
+ */
+void NtfQueue_Init(void);
+
+/**
+ * @brief Allocate a pool message, the payload is written in place.
+ *
+ * @return Payload of NTF_QUEUE_BUF_SIZE bytes, NULL if the pool is empty
+ */
+uint8_t * NtfQueue_Alloc(void);
+
+/**
+ * @brief Queue a payload to every connection of the mask. The payload is
+ *        shared by all queues, the last queue sends the pool message itself
+ *        and the others a copy. The pool message is replaced once sent.
+ *
+ * @param[in] buf       Payload from NtfQueue_Alloc(), ownership is passed
+ * @param[in] length    Payload length
+ * @param[in] handle    Attribute handle
+ * @param[in] operation GATTC_NOTIFY or GATTC_INDICATE
+ * @param[in] con_mask  NTF_QUEUE_CON() bits of the subscribers
+ *
+ * @return Number of connections the payload was queued to
+ */
+uint8_t NtfQueue_Send(uint8_t *buf, uint16_t length, uint16_t handle,
+                      uint8_t operation, uint32_t con_mask);
+
+/**
+ * @brief Drop every entry queued to a connection.
+ *
+ * @param[in] conidx Connection index
+ */
+void NtfQueue_Flush(uint8_t conidx);
+
+/**
+ * @brief Handle queued notification completions and disconnections.
+ */
+void NtfQueue_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                         ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read queue statistics of a connection
+ *
+ * @param[in] conidx Connection index
+ *
+ * @return Pointer to statistics
+ */
+const ntf_queue_stats_t * NtfQueue_Get_Stats(uint8_t conidx);
+
+/**
+ * @brief Read buffer pool statistics
+ *
+ * @return Pointer to statistics
+ */
+const ntf_queue_pool_stats_t * NtfQueue_Get_PoolStats(void);
+
+/**
+ * @brief Log the buffer pool and the queues that were used, one section of
+ *        the statistics report
+ */
+void NtfQueue_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* NTF_QUEUE_H_ */
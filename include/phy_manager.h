@@ -0,0 +1,124 @@
+/**
+ * @file phy_manager.h
+ * @brief PHY manager header file, selects 1M, 2M or Coded PHY per link from
+ *        the traffic and the link RSSI
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef PHY_MANAGER_H_
+#define PHY_MANAGER_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ke_msg.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* RSSI polling period of a link during bulk transfers (units of 1ms). Idle
+ * links are not polled, they keep the PHY chosen at the last transfer. */
+#define PHY_MGR_RSSI_PERIOD_MS          2000
+
+/* Average RSSI below which the link moves to Coded PHY, and above which it
+ * moves back (dBm) */
+#define PHY_MGR_CODED_ENTER_RSSI        (-85)
+#define PHY_MGR_CODED_EXIT_RSSI         (-75)
+
+/* Weight of a new RSSI reading in the average, as a power of 2 (1/4) */
+#define PHY_MGR_RSSI_SHIFT              2
+
+/**
+ * @brief PHYs accounted by the manager
+ */
+typedef enum
+{
+    PHY_MGR_1M = 0,
+    PHY_MGR_2M,
+    PHY_MGR_CODED,
+    PHY_MGR_PHY_NB
+} phy_mgr_phy_t;
+
+/**
+ * @brief PHY manager statistics
+ */
+typedef struct
+{
+    uint32_t requests;                      /**< PHY changes requested */
+    uint32_t changes;                       /**< PHY changes applied on any link */
+    uint32_t rssi_polls;                    /**< RSSI requests sent */
+    uint64_t time[PHY_MGR_PHY_NB];          /**< Link time per transmit PHY (RTC cycles) */
+    uint32_t bytes[PHY_MGR_PHY_NB];         /**< Application bytes sent per transmit PHY */
+} phy_mgr_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Request 2M PHY for a bulk transfer, or the PHY of the link quality
+ *        once it ends. The link RSSI is polled while the transfer runs.
+ *
+ * @param[in] conidx Connection index
+ * @param[in] bulk   true when a bulk transfer starts, false when it ends
+ */
+void PhyMgr_Set_Bulk(uint8_t conidx, bool bulk);
+
+/**
+ * @brief Account bytes sent on a link to its current PHY.
+ *
+ * @param[in] conidx Connection index
+ * @param[in] length Number of bytes
+ */
+void PhyMgr_Add_Bytes(uint8_t conidx, uint16_t length);
+
+/**
+ * @brief Poll the RSSI of links in bulk transfer and track the PHY in use.
+ */
+void PhyMgr_MsgHandler(ke_msg_id_t const msg_id, void const *param,
+                       ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/**
+ * @brief Read PHY manager statistics, time per PHY includes active links
+ *
+ * @return Pointer to statistics
+ */
+const phy_mgr_stats_t * PhyMgr_Get_Stats(void);
+
+/**
+ * @brief Log the PHY changes, RSSI polls, and the link time and bytes per
+ *        PHY, one section of the statistics report
+ */
+void PhyMgr_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* PHY_MANAGER_H_ */
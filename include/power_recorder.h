@@ -0,0 +1,145 @@
+/**
+ * @file power_recorder.h
+ * @brief Power state recorder header file, keeps the last power state
+ *        transitions with their timestamp and wakeup cause in retention RAM
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef POWER_RECORDER_H_
+#define POWER_RECORDER_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Set this to 0 to stop recording power state transitions */
+#define POWER_REC_ENABLE                1
+
+/* Number of transitions kept, must be a power of 2 */
+#define POWER_REC_SIZE                  128
+
+/* Dump the recorder through the trace every this many RTC wakeups,
+ * 0 disables the dump. Decode it with tools/power_trace_analyzer.py */
+#define POWER_REC_LOG_PERIOD            100
+
+/* Marks the recorder in retention RAM as valid */
+#define POWER_REC_MAGIC                 0x50575252
+
+/* Wakeup causes, can be combined */
+#define POWER_REC_CAUSE_NONE            0x00
+#define POWER_REC_CAUSE_RTC             0x01    /**< RTC alarm */
+#define POWER_REC_CAUSE_BB_TIMER        0x02    /**< BLE baseband timer */
+#define POWER_REC_CAUSE_GPIO1           0x04    /**< GPIO1 wakeup */
+#define POWER_REC_CAUSE_IRQ             0x08    /**< Any other interrupt */
+#define POWER_REC_CAUSE_RESET           0x10    /**< Reset or wakeup without retention */
+
+/**
+ * @brief Recorded power states
+ */
+typedef enum
+{
+    POWER_REC_RUN = 0,                      /**< Running */
+    POWER_REC_CPU_SLEEP,                    /**< CPU clock gated (WFI) */
+    POWER_REC_DEEP_SLEEP,                   /**< Sleep with core retention */
+    POWER_REC_DEEP_SLEEP_NO_RET             /**< Sleep without core retention */
+} power_rec_state_t;
+
+/**
+ * @brief One power state transition
+ */
+typedef struct
+{
+    uint32_t timestamp;                     /**< RTC cycles, lower 32 bits of RTC_Get_Timestamp() */
+    uint8_t state;                          /**< New power_rec_state_t */
+    uint8_t cause;                          /**< POWER_REC_CAUSE_* when entering POWER_REC_RUN */
+    uint16_t seq;                           /**< Sequence number, gaps show lost entries */
+} power_rec_entry_t;
+
+#if POWER_REC_ENABLE
+#define POWER_REC(state, cause)         PowerRec_Record(state, cause)
+#else    /* if POWER_REC_ENABLE */
+#define POWER_REC(state, cause)
+#endif    /* if POWER_REC_ENABLE */
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize the recorder. Entries in retention RAM are kept if they
+ *        are valid, and a run transition caused by reset is recorded.
+ */
+void PowerRec_Init(void);
+
+/**
+ * @brief Record a power state transition
+ *
+ * @param[in] state New power state
+ * @param[in] cause POWER_REC_CAUSE_* flags
+ */
+void PowerRec_Record(power_rec_state_t state, uint8_t cause);
+
+/**
+ * @brief Read the wakeup causes pending in the wakeup controller.
+ *
+ * @return POWER_REC_CAUSE_* flags, POWER_REC_CAUSE_IRQ if no wakeup event
+ *         is pending
+ *
+ * @note Call with interrupts disabled right after leaving a sleep mode,
+ *       before WAKEUP_IRQHandler clears the events.
+ */
+uint8_t PowerRec_Wakeup_Cause(void);
+
+/**
+ * @brief Start a dump of the recorder through the application trace. The
+ *        header and the first entries are logged, see
+ *        PowerRec_Dump_Continue().
+ */
+void PowerRec_Dump(void);
+
+/**
+ * @brief Log the next entries of the dump in progress, a few at a time so
+ *        the trace is never waited for.
+ */
+void PowerRec_Dump_Continue(void);
+
+/**
+ * @brief Called once per RTC wakeup, continues the dump in progress or
+ *        starts one every POWER_REC_LOG_PERIOD wakeups.
+ */
+void PowerRec_Dump_Periodic(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* POWER_RECORDER_H_ */
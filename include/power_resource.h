@@ -0,0 +1,140 @@
+/**
+ * @file power_resource.h
+ * @brief Peripheral power resource manager header file, keeps a power domain
+ *        on only while at least one user holds it
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef POWER_RESOURCE_H_
+#define POWER_RESOURCE_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/**
+ * @brief Power domains handled by the manager.
+ *
+ * A domain whose power down define in app.h (SENSOR_POWER_DISABLE,
+ * CC312AO_POWER_DISABLE, POWER_DOWN_FPU, POWER_DOWN_DBG, VDDIF_POWER_DOWN)
+ * is 1 is off until acquired. A domain whose define is 0 is pinned on.
+ */
+typedef enum
+{
+    POWER_DOMAIN_SENSOR = 0,                /**< Sensor interface */
+    POWER_DOMAIN_CC312,                     /**< CryptoCell, powering it down locks the debug port */
+    POWER_DOMAIN_FPU,                       /**< Floating point unit */
+    POWER_DOMAIN_DBG,                       /**< Debug unit */
+    POWER_DOMAIN_VDDIF,                     /**< VDDIF interface regulator */
+    POWER_DOMAIN_NB
+} power_domain_t;
+
+/**
+ * @brief Power domain state and statistics
+ */
+typedef struct
+{
+    uint8_t users;                          /**< Number of users holding the domain */
+    bool pinned;                            /**< Kept on by its app.h define */
+    bool on;                                /**< Powered, a refused power down keeps it on */
+    uint32_t power_ups;                     /**< Number of times the domain was powered up */
+    uint32_t denied;                        /**< Power downs refused by the Q-channel handshake */
+    uint64_t on_since;                      /**< Timestamp of last power up (RTC cycles) */
+    uint64_t on_cycles;                     /**< Total time powered, not counting the current on period (RTC cycles) */
+} power_domain_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Apply the initial power state of all domains. Replaces the power
+ *        down sequence of DeviceInit().
+ */
+void PowerRes_Init(void);
+
+/**
+ * @brief Take a reference on a power domain, powering it up if needed.
+ *
+ * @param[in] domain Power domain
+ *
+ * @return true if the domain is powered
+ */
+bool PowerRes_Acquire(power_domain_t domain);
+
+/**
+ * @brief Release a reference taken with PowerRes_Acquire(). The domain is
+ *        powered down when its last user releases it, a refused power down
+ *        is counted in denied and retried on the next release.
+ *
+ * @param[in] domain Power domain
+ */
+void PowerRes_Release(power_domain_t domain);
+
+/**
+ * @brief Check if a power domain is on
+ *
+ * @param[in] domain Power domain
+ *
+ * @return true if the domain is powered
+ */
+bool PowerRes_Is_On(power_domain_t domain);
+
+/**
+ * @brief Total time a domain was powered, including the current on period
+ *
+ * @param[in] domain Power domain
+ *
+ * @return On time in RTC cycles
+ */
+uint64_t PowerRes_Get_OnTime(power_domain_t domain);
+
+/**
+ * @brief Read power domain statistics
+ *
+ * @param[in] domain Power domain
+ *
+ * @return Pointer to statistics
+ */
+const power_domain_stats_t * PowerRes_Get_Stats(power_domain_t domain);
+
+/**
+ * @brief Log the users, power ups, refused power downs and on time of each
+ *        domain, one section of the statistics report
+ */
+void PowerRes_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* POWER_RESOURCE_H_ */
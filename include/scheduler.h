@@ -25,14 +25,15 @@
 #include "montana.h"
 #include "app.h"
 
-#define DEBUG_SCHEDULER         (0)             /**< Set 1 to enable scheduler debug logs. */
-
 #define SCHEDULER_TASK_MAX              (10)    /**< Maximum number of task that can be registered.  */
 #define SCHEDULER_MIN_BURST_TIME        CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_1S)     /**< Minimum time that task
                                                                                              * can wait to run. */
 #define SCHEDULER_MAX_BURST_TIME        CONVERT_MS_TO_32K_CYCLES(RTC_SLEEP_TIME_M(10))    /**< Maximum time that
                                                                                                * task can wait to run.
                                                                                                * */
+#define SCHEDULER_COALESCE_CYCLES       SLEEP_COORD_ALIGN_WINDOW_CYCLES     /**< Task that will be READY within
+                                                                             * this time is run in the current
+                                                                             * wakeup. */
 
 /** Function pointer for scheduler task */
 typedef void (*p_schedular_task_t)(void);
@@ -56,9 +57,10 @@ typedef struct scheduler_task_t
 {
 	p_schedular_task_t task_function;               /**< Function that gets called when task is READY. */
     uint32_t arrival_cycles;                /**< The period we want to put task to be READY (Number of RTC cycles) */
-    uint32_t count_cycles;                /**< Counter, If it reaches the arrival_cycles, then the timer puts it into
-                                           * READY state. */
+    int32_t count_cycles;                 /**< Counter, If it reaches the arrival_cycles, then the timer puts it into
+                                           * READY state. Negative after the task was run early. */
     Scheduler_Task_State_t task_state;                  /**< The current state of the task. */
+    clock_level_t clock_level;              /**< System clock level required while the task runs. */
 } scheduler_task;
 
 /**
@@ -116,6 +118,15 @@ uint64_t Scheduler_Calculate_SleepDuration(void);
  */
 void Scheduler_Set_ArrivalCycle(uint8_t scheduled_task_number, uint32_t arrival_cycle);
 
+/**
+ * @brief Set the system clock level required by the scheduled task
+ *
+ * @param[in] scheduled_task_number	Number of given task in scheduler_task_queue
+ * @param[in] clock_level           Level requested while the task runs,
+ *                                  CLOCK_LEVEL_LOW by default
+ */
+void Scheduler_Set_ClockLevel(uint8_t scheduled_task_number, clock_level_t clock_level);
+
 /**
  * @brief Create a task/s for scheduler.
  */
@@ -35,6 +35,6 @@ void Task0_BLEAdvControl(void);
 
 void Task1_Dummy(void);
 
-void Task2_Dummy(void);
+void Task2_Broadcast(void);
 
 #endif    /* INCLUDE_SCHEDULER_TASKS_H_ */
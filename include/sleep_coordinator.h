@@ -0,0 +1,136 @@
+/**
+ * @file sleep_coordinator.h
+ * @brief Sleep coordinator header file, merges the scheduler RTC deadline and
+ *        the BLE baseband wakeups into one wakeup plan
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef SLEEP_COORDINATOR_H_
+#define SLEEP_COORDINATOR_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+struct ble_sleep_api_param_tag;
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Convert RTC cycles (32.768 kHz) to BLE half-slots (312.5 us) and back */
+#define RTC_CYCLES_TO_HALF_SLOTS(x)         ((uint64_t)(x) * 25 / 256)
+#define HALF_SLOTS_TO_RTC_CYCLES(x)         ((uint64_t)(x) * 256 / 25)
+
+/* Milliseconds to RTC cycles in integer arithmetic, these limits are
+ * compared in the wakeup interrupt and with interrupts disabled */
+#define SLEEP_COORD_MS_TO_CYCLES(ms)        ((uint32_t)((ms) * 32768UL / 1000))
+
+/* RTC cycles kept between the BLE wakeup and the scheduler deadline so the
+ * baseband is awake and restored when the RTC alarm fires */
+#define SLEEP_COORD_GUARD_CYCLES            SLEEP_COORD_MS_TO_CYCLES(1)
+
+/* A scheduler deadline is moved onto the next BLE wakeup if that wakeup
+ * happens at most this many RTC cycles before the deadline */
+#define SLEEP_COORD_ALIGN_WINDOW_CYCLES     SLEEP_COORD_MS_TO_CYCLES(100)
+
+/* Do not align to BLE wakeups closer than this, the RTC re-programming
+ * itself takes a couple of RTC cycles */
+#define SLEEP_COORD_MIN_ALIGN_CYCLES        SLEEP_COORD_MS_TO_CYCLES(10)
+
+/* Shortest and longest BLE wakeup period accepted as periodic activity
+ * (7.5 ms connection interval up to 10.24 s advertising interval) */
+#define SLEEP_COORD_BLE_PERIOD_MIN_CYCLES   SLEEP_COORD_MS_TO_CYCLES(7)
+#define SLEEP_COORD_BLE_PERIOD_MAX_CYCLES   SLEEP_COORD_MS_TO_CYCLES(10240)
+
+/* Returned when no BLE wakeup can be predicted */
+#define SLEEP_COORD_NO_BLE_EVENT            ((uint32_t)0xFFFFFFFF)
+
+/**
+ * @brief Sleep coordinator statistics
+ */
+typedef struct
+{
+    uint32_t ble_wakeups;              /**< Number of BB timer wakeups observed */
+    uint32_t aligned_deadlines;        /**< Scheduler deadlines moved onto a BLE wakeup */
+    uint32_t ble_sleep_limited;        /**< Loops where the RTC deadline limited BLE sleep */
+} sleep_coord_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Limit BLE maximum sleep duration to the next scheduler deadline.
+ *
+ * @param[in,out] param BLE sleep API parameters passed to BLE_Baseband_Sleep()
+ *
+ * @note Called with interrupts disabled before every BLE_Baseband_Sleep().
+ */
+void SleepCoord_Prepare(struct ble_sleep_api_param_tag *param);
+
+/**
+ * @brief Record a BLE baseband timer wakeup. Called from the wakeup handler.
+ */
+void SleepCoord_BLE_Wakeup(void);
+
+/**
+ * @brief Predict time to next BLE baseband wakeup.
+ *
+ * @return Number of RTC cycles before next BLE wakeup or
+ *         SLEEP_COORD_NO_BLE_EVENT if no periodic BLE activity is known
+ */
+uint32_t SleepCoord_Get_BLENextEvent(void);
+
+/**
+ * @brief Merge the scheduler deadline with the next BLE wakeup.
+ *
+ * @param[in] sched_cycles Number of RTC cycles before next scheduler deadline
+ *
+ * @return Number of RTC cycles to program in the RTC alarm
+ */
+uint64_t SleepCoord_Plan(uint64_t sched_cycles);
+
+/**
+ * @brief Read sleep coordinator statistics
+ *
+ * @return Pointer to statistics
+ */
+const sleep_coord_stats_t * SleepCoord_Get_Stats(void);
+
+/**
+ * @brief Log the BLE wakeups and the deadlines aligned on them, one section
+ *        of the statistics report
+ */
+void SleepCoord_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* SLEEP_COORDINATOR_H_ */
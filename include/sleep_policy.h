@@ -0,0 +1,160 @@
+/**
+ * @file sleep_policy.h
+ * @brief Sleep mode selection header file, picks the power mode with the
+ *        lowest energy for the time left before the next deadline
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef SLEEP_POLICY_H_
+#define SLEEP_POLICY_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Set this to 1 to let the policy select sleep without core retention.
+ * note: only enable it if the application restores its state when waking up
+ * from a no-retention sleep */
+#define SLEEP_POLICY_NO_RETENTION_ENABLE        0
+
+/* Per mode costs used to compute the break-even time of each mode.
+ * These are typical values at VBAT = 1.2 V, characterize them on the target
+ * board for accurate selection.
+ *   - ENERGY:  energy spent to enter and exit the mode (nJ)
+ *   - LATENCY: time to enter and exit the mode (us)
+ *   - POWER:   average power while in the mode (nW) */
+#define SLEEP_POLICY_WFI_ENERGY                 0
+#define SLEEP_POLICY_WFI_LATENCY                0
+#define SLEEP_POLICY_WFI_POWER                  840000
+
+#define SLEEP_POLICY_RET_ENERGY                 3000
+#define SLEEP_POLICY_RET_LATENCY                (TWOSC + 500)
+#define SLEEP_POLICY_RET_POWER                  1800
+
+#define SLEEP_POLICY_NORET_ENERGY               8000
+#define SLEEP_POLICY_NORET_LATENCY              (TWOSC + 1500)
+#define SLEEP_POLICY_NORET_POWER                500
+
+/* Marks the statistics in retention RAM as valid */
+#define SLEEP_POLICY_STATS_MAGIC                0x534C5053
+
+/* Convert RTC cycles to microseconds */
+#define RTC_CYCLES_TO_US(x)                     ((uint64_t)(x) * 15625 / 512)
+
+/**
+ * @brief Power modes the policy can select
+ */
+typedef enum
+{
+    SLEEP_POLICY_WFI = 0,                   /**< CPU clock gated, everything else running */
+    SLEEP_POLICY_DEEP_RETENTION,            /**< Sleep with core retention */
+    SLEEP_POLICY_DEEP_NO_RETENTION,         /**< Sleep without core retention */
+    SLEEP_POLICY_MODE_NB
+} sleep_policy_mode_t;
+
+/**
+ * @brief Entry/exit and residency cost of a power mode
+ */
+typedef struct
+{
+    uint32_t energy_nj;                     /**< Energy to enter and exit the mode (nJ) */
+    uint32_t latency_us;                    /**< Time to enter and exit the mode (us) */
+    uint32_t power_nw;                      /**< Average power while in the mode (nW) */
+} sleep_policy_cost_t;
+
+/**
+ * @brief Per mode statistics
+ */
+typedef struct
+{
+    uint32_t entries;                       /**< Number of times the mode was entered */
+    uint64_t residency_cycles;              /**< Total time spent in the mode (RTC cycles) */
+    uint32_t demoted;                       /**< Deep sleep allowed by BLE but this mode was cheaper */
+} sleep_policy_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize the statistics. Statistics in retention RAM are kept if
+ *        they are valid, and a sleep without retention entered before this
+ *        boot is counted.
+ */
+void SleepPolicy_Init(void);
+
+/**
+ * @brief Override the cost of a power mode.
+ *
+ * @param[in] mode Power mode
+ * @param[in] cost New entry/exit and residency cost
+ */
+void SleepPolicy_Set_Cost(sleep_policy_mode_t mode, const sleep_policy_cost_t *cost);
+
+/**
+ * @brief Select the power mode with the lowest energy until the next deadline.
+ *
+ * @param[in] deep_sleep_allowed true if BLE_Baseband_Sleep() allows deep sleep
+ *
+ * @return Selected power mode
+ */
+sleep_policy_mode_t SleepPolicy_Select(bool deep_sleep_allowed);
+
+/**
+ * @brief Enter the given power mode and account its residency.
+ *
+ * @param[in] mode Power mode
+ *
+ * @note Called with interrupts disabled.
+ */
+void SleepPolicy_Enter(sleep_policy_mode_t mode);
+
+/**
+ * @brief Read statistics for a power mode
+ *
+ * @param[in] mode Power mode
+ *
+ * @return Pointer to statistics
+ */
+const sleep_policy_stats_t * SleepPolicy_Get_Stats(sleep_policy_mode_t mode);
+
+/**
+ * @brief Log the entries, residency and demotions of each power mode, one
+ *        section of the statistics report
+ */
+void SleepPolicy_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* SLEEP_POLICY_H_ */
@@ -0,0 +1,80 @@
+/**
+ * @file stats_report.h
+ * @brief Statistics report header file, logs the counters kept by the
+ *        application modules through the deferred trace log
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef STATS_REPORT_H_
+#define STATS_REPORT_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Start a report every this many RTC wakeups, 0 disables the report. One
+ * module is logged per wakeup so the records fit in the trace log ring.
+ * Decode the capture with tools/log_decoder.py */
+#define STATS_REPORT_PERIOD             120
+
+/* Largest number of modules in the report */
+#define STATS_REPORT_SECTION_NB         20
+
+/* RTC cycles to milliseconds, truncated to 32 bits for TRACE_LOG() */
+#define STATS_REPORT_MS(cycles)         ((uint32_t)(((uint64_t)(cycles) * 1000) / 32768))
+
+/* Logs the statistics of one module through TRACE_LOG() */
+typedef void (*stats_report_section_t)(void);
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Add a module to the report, sections are logged in the order they
+ *        were added. Called at initialization.
+ *
+ * @param[in] section Function logging the statistics of the module
+ */
+void StatsReport_Add(stats_report_section_t section);
+
+/**
+ * @brief Called once per RTC wakeup, logs the statistics of the next module
+ *        of the report in progress or starts a report every
+ *        STATS_REPORT_PERIOD wakeups.
+ */
+void StatsReport_Periodic(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* STATS_REPORT_H_ */
@@ -0,0 +1,235 @@
+/**
+ * @file trace_log.h
+ * @brief Deferred trace log header file, records a format ID and raw
+ *        arguments in a RAM ring instead of formatting text on the device
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef TRACE_LOG_H_
+#define TRACE_LOG_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Set this to 0 to compile out all TRACE_LOG() and TRACE_LOG_HEX() calls */
+#define TRACE_LOG_ENABLE                1
+
+/* Size of the record ring in bytes, must be a power of 2 */
+#define TRACE_LOG_RING_SIZE             1024
+
+/* Largest record payload: TRACE_LOG() arguments (4 bytes each) or
+ * TRACE_LOG_HEX() bytes. Longer hex dumps are split in several records. */
+#define TRACE_LOG_MAX_PAYLOAD           64
+#define TRACE_LOG_MAX_ARGS              (TRACE_LOG_MAX_PAYLOAD / 4)
+
+/* Records are framed in two buffers of this size, the DMA sends one while
+ * the other is filled. The DMA interrupt refills them until the ring is
+ * empty. */
+#define TRACE_LOG_DMA_BUF_SIZE          128
+
+/* DMA channel sending the buffers to the UART. Channel 0 is used for the RF
+ * register transfers (app_sleep_mode_cfg.DMA_channel_RF). */
+#define TRACE_LOG_DMA_NUM               1
+#define TRACE_LOG_DMA                   (&DMA[TRACE_LOG_DMA_NUM])
+#define TRACE_LOG_DMA_IRQn              DMA1_IRQn
+#define TRACE_LOG_DMA_IRQHandler        DMA1_IRQHandler
+
+/* Byte transfers from memory to the UART, interrupt when complete */
+#define TRACE_LOG_DMA_CFG               (DMA_SRC_MEMORY | DMA_DEST_UART |    \
+                                         DMA_SRC_ADDR_INCR |                 \
+                                         DMA_DEST_ADDR_STATIC |              \
+                                         WORD_SIZE_8BITS_TO_8BITS |          \
+                                         DMA_COMPLETE_INT_ENABLE | DMA_ENABLE)
+
+/* UART transmit requests are routed to the DMA only during a transfer,
+ * swmTrace uses the UART interrupt otherwise */
+#define TRACE_LOG_UART_DMA_ENABLE()     (UART->CFG |= UART_DMA_ENABLE)
+#define TRACE_LOG_UART_DMA_DISABLE()    (UART->CFG &= ~UART_DMA_ENABLE)
+
+/* Format ID of the text logs queued while the DMA is sending, the payload
+ * is the formatted text. Longer texts are cut at TRACE_LOG_TEXT_MAX - 1
+ * characters. */
+#define TRACE_LOG_FMT_TEXT              0xFFFF
+#define TRACE_LOG_TEXT_MAX              128
+
+/* Record header: format ID (2 bytes), payload length, flags and sequence
+ * number, lower 32 bits of the RTC timestamp */
+#define TRACE_LOG_HEADER_SIZE           8
+
+/* Record header flags, shared with tools/log_decoder.py */
+#define TRACE_LOG_FLAG_HEX              0x80    /**< Payload is a byte dump */
+#define TRACE_LOG_SEQ_MASK              0x7F    /**< Sequence number, gaps are dropped records */
+
+/* Pass a 64-bit argument to a %llu, %lld or %llx conversion */
+#define TRACE_LOG_U64(x)                (uint32_t)(x), (uint32_t)((uint64_t)(x) >> 32)
+
+#if TRACE_LOG_ENABLE
+
+/* Format strings are kept in the .logstr section, which is only in the ELF
+ * file. The offset of a string in the section is its format ID. */
+#define TRACE_LOG_FMT(name, fmt)                                        \
+    static const char name[] __attribute__((section(".logstr"))) = fmt
+
+/* Record a log with up to TRACE_LOG_MAX_ARGS integer arguments. Arguments
+ * are truncated to 32 bits, %s is not supported. Records are filtered as
+ * APP_LOG_INFO() of the module.
+ * Decode the UART capture with tools/log_decoder.py. */
+#define TRACE_LOG(fmt, ...)                                                 \
+    do                                                                      \
+    {                                                                       \
+        if (APP_LOG_ON(APP_LOG_LEVEL_INFO))                                 \
+        {                                                                   \
+            TRACE_LOG_FMT(trace_log_fmt, fmt);                              \
+            const uint32_t trace_log_args[] = { 0, ##__VA_ARGS__ };         \
+            TraceLog_Write((uint16_t)(uint32_t)trace_log_fmt,               \
+                           &trace_log_args[1],                              \
+                           (sizeof(trace_log_args) / sizeof(uint32_t)) - 1); \
+        }                                                                   \
+    } while (0)
+
+/* Record a byte dump, printed in hex in place of the %s of fmt */
+#define TRACE_LOG_HEX(fmt, data, length)                                    \
+    do                                                                      \
+    {                                                                       \
+        if (APP_LOG_ON(APP_LOG_LEVEL_INFO))                                 \
+        {                                                                   \
+            TRACE_LOG_FMT(trace_log_fmt, fmt);                              \
+            TraceLog_Write_Hex((uint16_t)(uint32_t)trace_log_fmt,           \
+                               (data), (length));                           \
+        }                                                                   \
+    } while (0)
+
+#else    /* if TRACE_LOG_ENABLE */
+
+#define TRACE_LOG(fmt, ...)
+#define TRACE_LOG_HEX(fmt, data, length)
+
+#endif    /* if TRACE_LOG_ENABLE */
+
+/**
+ * @brief Deferred trace log statistics
+ */
+typedef struct
+{
+    uint32_t records;                       /**< Records written in the ring */
+    uint32_t dropped;                       /**< Records lost because the ring was full */
+    uint32_t sent_bytes;                    /**< Bytes sent on the UART */
+    uint32_t dma_transfers;                 /**< DMA transfers started */
+    uint32_t texts;                         /**< Text logs queued behind a DMA transfer */
+    uint16_t peak_bytes;                    /**< Highest ring usage (bytes) */
+} trace_log_stats_t;
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Write a record with 32-bit arguments in the ring. Use TRACE_LOG().
+ *
+ * @param[in] fmt_id Offset of the format string in the .logstr section
+ * @param[in] args   Arguments
+ * @param[in] nargs  Number of arguments
+ *
+ * @note Can be called from interrupts.
+ */
+void TraceLog_Write(uint16_t fmt_id, const uint32_t *args, uint8_t nargs);
+
+/**
+ * @brief Write a byte dump in the ring. Use TRACE_LOG_HEX().
+ *
+ * @param[in] fmt_id Offset of the format string in the .logstr section
+ * @param[in] data   Bytes to dump
+ * @param[in] length Number of bytes
+ *
+ * @note Can be called from interrupts.
+ */
+void TraceLog_Write_Hex(uint16_t fmt_id, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Format a text log in the ring, sent after the records before it.
+ *        Used by APP_LOG() while the DMA is sending.
+ *
+ * @param[in] fmt printf format string
+ *
+ * @note Can be called from interrupts.
+ */
+void TraceLog_Text(const char *fmt, ...);
+
+/**
+ * @brief Start sending the recorded logs if the DMA is idle, the DMA
+ *        interrupt then sends the records written meanwhile. Called from
+ *        the main loop after Trace_Flush(), does not wait. Nothing is sent
+ *        while swmTrace text is pending.
+ */
+void TraceLog_Drain(void);
+
+/**
+ * @brief Check if the DMA is sending on the UART. Sleep without the UART
+ *        clock must wait for the end of the transfer.
+ *
+ * @return true if a transfer is in progress or its last bytes are still
+ *         shifted out by the UART transmitter
+ */
+bool TraceLog_Busy(void);
+
+/**
+ * @brief Check if records are waiting to be sent
+ *
+ * @return true if the ring is not empty
+ */
+bool TraceLog_Pending(void);
+
+/**
+ * @brief DMA transfer complete interrupt, starts the other buffer and
+ *        refills the one sent while records are left in the ring
+ */
+void TRACE_LOG_DMA_IRQHandler(void);
+
+/**
+ * @brief Read deferred trace log statistics
+ *
+ * @return Pointer to statistics
+ */
+const trace_log_stats_t * TraceLog_Get_Stats(void);
+
+/**
+ * @brief Log the ring and DMA transfer counters, one section of the
+ *        statistics report. The record is counted in the next report.
+ */
+void TraceLog_Log_Stats(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* TRACE_LOG_H_ */
@@ -0,0 +1,155 @@
+/**
+ * @file wakeup_profiler.h
+ * @brief Wakeup profiler header file, measures the phases of each wakeup
+ *        cycle and keeps log2 histograms of them in retention RAM
+ *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef WAKEUP_PROFILER_H_
+#define WAKEUP_PROFILER_H_
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif    /* ifdef __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Set this to 0 to remove the profiler marks from the wakeup path */
+#define PROFILER_ENABLE                 1
+
+/* Log the histograms every this many RTC wakeups, 0 disables the log */
+#define PROFILER_LOG_PERIOD             60
+
+/* Number of log2 buckets, bucket n counts durations of [2^n, 2^(n+1)) us,
+ * the last bucket also counts everything longer */
+#define PROFILER_BUCKET_NB              16
+
+/* Marks the histograms in retention RAM as valid */
+#define PROFILER_MAGIC                  0x50524F46
+
+/**
+ * @brief Points of the wakeup cycle that are timestamped
+ */
+typedef enum
+{
+    PROFILER_POINT_WAKEUP = 0,              /**< WAKEUP_IRQHandler entry */
+    PROFILER_POINT_SCHED_START,             /**< Scheduler_Main start */
+    PROFILER_POINT_TASK_START,              /**< Scheduler task start */
+    PROFILER_POINT_TASK_END,                /**< Scheduler task end */
+    PROFILER_POINT_RTC_RECONFIG,            /**< RTC_ALARM_Reconfig return */
+    PROFILER_POINT_SLEEP_ENTER,             /**< Sys_PowerModes_Sleep_Enter call */
+    PROFILER_POINT_NB
+} profiler_point_t;
+
+/**
+ * @brief Phases of the wakeup cycle with a histogram
+ */
+typedef enum
+{
+    PROFILER_PHASE_WAKEUP_TO_SCHED = 0,     /**< Wakeup to scheduler start */
+    PROFILER_PHASE_SCHED,                   /**< Scheduler start to RTC re-configured */
+    PROFILER_PHASE_TASK,                    /**< Single task run */
+    PROFILER_PHASE_RTC_TO_SLEEP,            /**< RTC re-configured to sleep */
+    PROFILER_PHASE_ACTIVE,                  /**< Wakeup to sleep */
+    PROFILER_PHASE_NB
+} profiler_phase_t;
+
+#if PROFILER_ENABLE
+#define PROFILER_MARK(point)            Profiler_Mark(point)
+#else    /* if PROFILER_ENABLE */
+#define PROFILER_MARK(point)
+#endif    /* if PROFILER_ENABLE */
+
+/* ---------------------------------------------------------------------------
+* Function prototype definitions
+* --------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize the profiler. Histograms in retention RAM are kept if
+ *        they are valid, otherwise they are cleared.
+ */
+void Profiler_Init(void);
+
+/**
+ * @brief Timestamp a point of the wakeup cycle and update the histograms of
+ *        the phases ending at this point.
+ *
+ * @param[in] point Point reached
+ */
+void Profiler_Mark(profiler_point_t point);
+
+/**
+ * @brief Account the cycles counted so far at the current clock. Called
+ *        before the system clock changes.
+ */
+void Profiler_Clock_Change(void);
+
+/**
+ * @brief Read the free running cycle counter started at each wakeup from
+ *        sleep, used to time code between two reads.
+ *
+ * @return Core clock cycles since the last wakeup, constant if the profiler
+ *         is disabled
+ */
+uint32_t Profiler_Get_Cycles(void);
+
+/**
+ * @brief Clear all histograms
+ */
+void Profiler_Reset(void);
+
+/**
+ * @brief Serialize a phase histogram: phase, bucket count, then one
+ *        saturated little-endian uint16_t per bucket.
+ *
+ * @param[in]  phase Phase to serialize
+ * @param[out] buf   Destination buffer
+ * @param[in]  len   Destination buffer size
+ *
+ * @return Number of bytes written
+ */
+uint16_t Profiler_Get_Histogram(uint8_t phase, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief Log all histograms through the application trace
+ */
+void Profiler_Log(void);
+
+/**
+ * @brief Called once per RTC wakeup, logs the histograms every
+ *        PROFILER_LOG_PERIOD wakeups.
+ */
+void Profiler_Log_Periodic(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif    /* ifdef __cplusplus */
+
+#endif    /* WAKEUP_PROFILER_H_ */
@@ -144,6 +144,10 @@ void RTC_ClockSource_Init(void);
 uint32_t RTC_ALARM_Reconfig(uint32_t timer_counter, uint32_t pre_timer_counter,
                             bool prog_relative_timer_count);
 
+uint32_t RTC_ALARM_Get_RemainingCycles(void);
+
+uint64_t RTC_Get_Timestamp(void);
+
 void Wakeup_Source_Config(void);
 
 /* ----------------------------------------------------------------------------
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""Compute the DRAM banks to keep powered from a GNU ld map file.
+
+Reads the output sections placed in DRAM by sections_light.ld, works out which
+8 KB DRAM instances hold data that must survive sleep, and writes
+include/dram_power_mask.h with the matching DRAM_POWER_BYTE mask.
+
+With --check the existing header is compared to the map instead: the build
+fails if a retained section lands in a bank the header gates, and a warning is
+printed if the header keeps banks powered that hold nothing.
+
+Usage:
+    dram_bank_mask.py [--check] <map file> <header file>
+"""
+
+import argparse
+import re
+import sys
+
+DRAM_BASE = 0x20000000
+DRAM_BANK_SIZE = 0x2000
+DRAM_BANK_COUNT = 8
+
+# Output sections that must be retained during sleep. The BLE stack heaps are
+# static arrays and end up in .bss.
+RETAINED_SECTIONS = (
+    ".systemclock",
+    ".romstatus",
+    ".wakeupsection",
+    ".data",
+    ".bss",
+    ".noinit",
+    "._stack",
+)
+
+SECTION_RE = re.compile(r"^(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?")
+ADDR_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+MASK_RE = re.compile(r"^\s*#define\s+DRAM_RETAINED_POWER_MASK\s+(.+)$", re.MULTILINE)
+MASK_BIT_RE = re.compile(r"^DRAM(\d+)_POWER_ENABLE_BYTE$")
+
+HEADER_TEMPLATE = """\
+/**
+ * @file dram_power_mask.h
+ * @brief DRAM instances kept powered in sleep for CFG_REDUCED_DRAM builds
+ *
+ * Generated by tools/dram_bank_mask.py from the linker map, do not edit.
+ * Re-generate after changing the DRAM layout or the retained data:
+ *     python tools/dram_bank_mask.py <project>.map include/dram_power_mask.h
+ *
+{banks} *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef DRAM_POWER_MASK_H_
+#define DRAM_POWER_MASK_H_
+
+/* Number of DRAM instances holding retained data */
+#define DRAM_RETAINED_BANK_COUNT        {count}
+
+/* DRAM_POWER_BYTE value enabling only the retained DRAM instances */
+#define DRAM_RETAINED_POWER_MASK        ({mask})
+
+#endif    /* DRAM_POWER_MASK_H_ */
+"""
+
+
+def parse_map(path):
+    """Return {section: (address, size)} for the output sections in the map."""
+    sections = {}
+    pending = None
+
+    with open(path) as f:
+        for line in f:
+            if pending:
+                m = ADDR_RE.match(line)
+                if m:
+                    sections[pending] = (int(m.group(1), 16), int(m.group(2), 16))
+                pending = None
+                continue
+
+            m = SECTION_RE.match(line)
+            if not m:
+                continue
+            if m.group(2) is None:
+                # Long section names put address and size on the next line
+                pending = m.group(1)
+            else:
+                sections[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+
+    return sections
+
+
+def bank_usage(sections):
+    """Return a list of retained section names per DRAM bank."""
+    banks = [[] for _ in range(DRAM_BANK_COUNT)]
+    dram_top = DRAM_BASE + DRAM_BANK_COUNT * DRAM_BANK_SIZE
+
+    for name in RETAINED_SECTIONS:
+        if name not in sections:
+            continue
+        addr, size = sections[name]
+        if size == 0 or addr < DRAM_BASE or addr >= dram_top:
+            continue
+        first = (addr - DRAM_BASE) // DRAM_BANK_SIZE
+        last = (addr + size - 1 - DRAM_BASE) // DRAM_BANK_SIZE
+        for bank in range(first, min(last, DRAM_BANK_COUNT - 1) + 1):
+            banks[bank].append(name)
+
+    return banks
+
+
+def write_header(path, banks):
+    lines = ""
+    enabled = []
+    for i, users in enumerate(banks):
+        state = "retained" if users else "gated"
+        detail = " (" + " ".join(users) + ")" if users else ""
+        lines += " *   DRAM%d: %s%s\n" % (i, state, detail)
+        if users:
+            enabled.append("DRAM%d_POWER_ENABLE_BYTE" % i)
+
+    with open(path, "w", newline="\n") as f:
+        f.write(HEADER_TEMPLATE.format(banks=lines,
+                                       count=len(enabled),
+                                       mask=" | ".join(enabled) if enabled else "0"))
+
+
+def parse_mask(text):
+    """Return the banks enabled by DRAM_RETAINED_POWER_MASK, None if the
+    macro is missing or not an OR of DRAMn_POWER_ENABLE_BYTE."""
+    m = MASK_RE.search(text)
+    if not m:
+        return None
+
+    value = m.group(1).split("/*")[0].strip()
+    if value.startswith("(") and value.endswith(")"):
+        value = value[1:-1].strip()
+    if value == "0":
+        return set()
+
+    powered = set()
+    for term in value.split("|"):
+        bit = MASK_BIT_RE.match(term.strip())
+        if not bit:
+            return None
+        powered.add(int(bit.group(1)))
+
+    return powered
+
+
+def check_header(path, banks):
+    try:
+        with open(path) as f:
+            text = f.read()
+    except OSError as e:
+        print("error: cannot read %s: %s" % (path, e), file=sys.stderr)
+        return 1
+
+    powered = parse_mask(text)
+    if powered is None:
+        print("error: cannot parse DRAM_RETAINED_POWER_MASK in %s" % path, file=sys.stderr)
+        return 1
+
+    status = 0
+
+    for i, users in enumerate(banks):
+        if users and i not in powered:
+            print("error: DRAM%d is gated in sleep but holds %s" % (i, " ".join(users)),
+                  file=sys.stderr)
+            status = 1
+        elif not users and i in powered:
+            print("warning: DRAM%d is retained but holds no retained data" % i,
+                  file=sys.stderr)
+
+    if status:
+        print("error: re-generate %s with tools/dram_bank_mask.py" % path, file=sys.stderr)
+
+    return status
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true",
+                        help="verify the header against the map instead of writing it")
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("header", help="generated header (include/dram_power_mask.h)")
+    args = parser.parse_args()
+
+    sections = parse_map(args.map)
+    if not any(name in sections for name in RETAINED_SECTIONS):
+        print("error: no DRAM sections found in %s" % args.map, file=sys.stderr)
+        return 1
+
+    banks = bank_usage(sections)
+
+    if args.check:
+        return check_header(args.header, banks)
+
+    write_header(args.header, banks)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Size the BLE stack heaps from recorded peak usage.
+
+The firmware dumps the kernel heap peaks (code/heap_profile.c) through the
+trace UART as:
+
+    HEAPPROF <max con> <env size> <env peak> <db size> <db peak>
+             <msg size> <msg peak> <non_ret size> <non_ret peak>
+
+Feed UART captures taken under the heaviest expected load (all connections
+open, streaming, pairing) to this script. The largest peak of each heap,
+plus a margin, is written to include/ble_heap_profile.h, used by
+ble_protocol_config.h when APP_HEAP_PROFILE_SIZES is 1.
+
+With --check the existing header is compared to the captures instead: the
+script exits with status 1 if a recorded peak exceeds the profiled size. No
+build step runs it, the captures are not kept with the project; run it on
+new captures before keeping a header.
+
+Usage:
+    heap_profile.py [--check] [--connections N] [--margin PCT]
+                    <header file> <capture file> ...
+"""
+
+import argparse
+import re
+import sys
+
+HEAPS = ("ENV", "DB", "MSG", "NON_RET")
+
+# Smallest margin kept on each heap (bytes), covers one more kernel message
+MIN_MARGIN = 64
+
+PROF_RE = re.compile(r"HEAPPROF (\d+)" + r" (\d+) (\d+)" * len(HEAPS))
+SIZE_RE = re.compile(r"#define APP_HEAP_PROFILE_(\w+)_SIZE\s+(\d+)")
+
+HEADER_TEMPLATE = """\
+/**
+ * @file ble_heap_profile.h
+ * @brief BLE stack heap sizes from recorded peak usage
+ *
+ * Generated by tools/heap_profile.py from trace captures, do not edit.
+ * Re-generate after changing the connection count, services or traffic:
+ *     python tools/heap_profile.py include/ble_heap_profile.h <capture> ...
+ *
+ * Recorded with up to {max_con} connections, {margin}% margin:
+{heaps} *
+ * @copyright @parblock
+ * Copyright (c) 2022 Semiconductor Components Industries, LLC (d/b/a
+ * onsemi), All Rights Reserved
+ *
+ * This code is the property of onsemi and may not be redistributed
+ * in any form without prior written permission from onsemi.
+ * The terms of use and warranty for this code are covered by contractual
+ * agreements between onsemi and the licensee.
+ *
+ * This is Reusable Code.
+ * @endparblock
+ */
+
+#ifndef BLE_HEAP_PROFILE_H_
+#define BLE_HEAP_PROFILE_H_
+
+/* Heap sizes in bytes */
+{defines}
+#endif    /* BLE_HEAP_PROFILE_H_ */
+"""
+
+
+def read_peaks(paths):
+    """Return (max connections, {heap: (size, peak)}) over all captures."""
+    max_con = 0
+    heaps = {}
+
+    for path in paths:
+        stream = sys.stdin if path == "-" else open(path, errors="replace")
+        with stream:
+            for line in stream:
+                m = PROF_RE.search(line)
+                if not m:
+                    continue
+                values = [int(v) for v in m.groups()]
+                max_con = max(max_con, values[0])
+                for i, heap in enumerate(HEAPS):
+                    size, peak = values[1 + 2 * i], values[2 + 2 * i]
+                    old_size, old_peak = heaps.get(heap, (size, 0))
+                    heaps[heap] = (max(old_size, size), max(old_peak, peak))
+
+    return max_con, heaps
+
+
+def sized(peak, margin):
+    """Peak plus margin, rounded up to a word."""
+    extra = max(peak * margin // 100, MIN_MARGIN)
+    return (peak + extra + 3) & ~3
+
+
+def write_header(path, max_con, heaps, margin):
+    lines = ""
+    defines = ""
+    for heap in HEAPS:
+        size, peak = heaps[heap]
+        new = sized(peak, margin)
+        lines += " *   %-8s peak %5d of %5d, sized %5d\n" % (heap.lower(), peak, size, new)
+        defines += "#define %-32s%d\n" % ("APP_HEAP_PROFILE_%s_SIZE" % heap, new)
+
+    with open(path, "w", newline="\n") as f:
+        f.write(HEADER_TEMPLATE.format(max_con=max_con, margin=margin,
+                                       heaps=lines, defines=defines))
+
+
+def check_header(path, heaps):
+    try:
+        with open(path) as f:
+            sizes = {name: int(value) for name, value in SIZE_RE.findall(f.read())}
+    except OSError as e:
+        print("error: cannot read %s: %s" % (path, e), file=sys.stderr)
+        return 1
+
+    status = 0
+    for heap in HEAPS:
+        peak = heaps[heap][1]
+        if heap not in sizes:
+            print("error: %s heap missing from %s" % (heap.lower(), path), file=sys.stderr)
+            status = 1
+        elif peak > sizes[heap]:
+            print("error: %s heap peak %d exceeds profiled size %d"
+                  % (heap.lower(), peak, sizes[heap]), file=sys.stderr)
+            status = 1
+
+    if status:
+        print("error: re-generate %s with tools/heap_profile.py" % path, file=sys.stderr)
+
+    return status
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true",
+                        help="verify the header against the captures instead of writing it, "
+                             "exit status 1 if a peak exceeds it")
+    parser.add_argument("--connections", type=int, default=3,
+                        help="connections the profile must cover, APP_MAX_NB_CON (default 3)")
+    parser.add_argument("--margin", type=int, default=15,
+                        help="margin added to each peak, in percent (default 15)")
+    parser.add_argument("header", help="generated header (include/ble_heap_profile.h)")
+    parser.add_argument("captures", nargs="+", help="UART captures, - for stdin")
+    args = parser.parse_args()
+
+    max_con, heaps = read_peaks(args.captures)
+    if not heaps:
+        print("error: no HEAPPROF lines found", file=sys.stderr)
+        return 1
+
+    if max_con < args.connections:
+        print("warning: captures reach %d of %d connections, heaps may be undersized"
+              % (max_con, args.connections), file=sys.stderr)
+
+    if args.check:
+        return check_header(args.header, heaps)
+
+    write_header(args.header, max_con, heaps, args.margin)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
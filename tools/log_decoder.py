@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Decode the deferred trace log records of a UART capture.
+
+TRACE_LOG() and TRACE_LOG_HEX() (include/trace_log.h) do not format text on
+the device. They record a format ID and the raw arguments, sent on the trace
+UART between the swmTrace text logs as:
+
+    00 <COBS encoded record> 00
+
+with the record:
+
+    <format ID:2> <payload length:1> <flags:1> <timestamp:4> <payload>
+
+The format ID is the offset of the format string in the .logstr section of
+the ELF file. The timestamp is the lower 32 bits of the RTC cycle counter
+(32768 Hz). The payload holds 32-bit little endian arguments, or raw bytes
+printed in hex in place of %s when TRACE_LOG_FLAG_HEX is set in the flags.
+The lower 7 bits of the flags are a sequence number, gaps are reported as
+dropped records. Text logged while the DMA was sending is recorded with the
+format ID 0xFFFF and the text as payload.
+
+Text found between the records is printed as is.
+
+Usage:
+    log_decoder.py [--no-timestamp] <ELF file> <binary capture file or ->
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+RTC_HZ = 32768.0
+
+HEADER_SIZE = 8
+FMT_TEXT = 0xFFFF
+FLAG_HEX = 0x80
+SEQ_MASK = 0x7F
+
+# printf conversion: flags, width, precision, length modifier, conversion
+CONVERSION_RE = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\d*)(?:\.(?P<prec>\d+))?"
+    r"(?P<length>hh|h|ll|l|z|j|t)?(?P<conv>[diuxXcsp%])")
+
+
+def read_logstr(path):
+    """Return the content of the .logstr section of a 32-bit ELF file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        raise ValueError("%s is not a 32-bit ELF file" % path)
+
+    endian = "<" if elf[5] == 1 else ">"
+    shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+
+    def section(index):
+        # sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size
+        return struct.unpack_from(endian + "IIIIII", elf, shoff + index * shentsize)
+
+    names_offset = section(shstrndx)[4]
+    for index in range(shnum):
+        name, _, _, _, offset, size = section(index)
+        end = elf.index(b"\0", names_offset + name)
+        if elf[names_offset + name:end] == b".logstr":
+            return elf[offset:offset + size]
+
+    raise ValueError("no .logstr section in %s" % path)
+
+
+def format_string(logstr, fmt_id):
+    """Return the NUL terminated format string at fmt_id."""
+    if fmt_id >= len(logstr):
+        return None
+    end = logstr.find(b"\0", fmt_id)
+    return logstr[fmt_id:end if end >= 0 else None].decode("latin-1")
+
+
+def cobs_decode(data):
+    """Return the decoded frame, None if it is not valid COBS."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def render(fmt, words, hex_dump):
+    """Apply the C format string to the recorded arguments."""
+    args = iter(words)
+
+    def convert(m):
+        conv = m.group("conv")
+        if conv == "%":
+            return "%"
+        if conv == "s":
+            return hex_dump if hex_dump is not None else "<str>"
+
+        value = next(args, 0)
+        if m.group("length") == "ll":
+            value |= next(args, 0) << 32
+            bits = 64
+        else:
+            bits = 32
+
+        spec = "%" + m.group("flags") + m.group("width")
+        if m.group("prec") is not None:
+            spec += "." + m.group("prec")
+
+        if conv in "diu":
+            if conv != "u" and value & (1 << (bits - 1)):
+                value -= 1 << bits
+            return (spec + "d") % value
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "p":
+            return "0x%08x" % value
+        return (spec + conv) % value
+
+    return CONVERSION_RE.sub(convert, fmt)
+
+
+def decode_record(logstr, record):
+    """Return (timestamp, seq, text, is_text) of a record, None if it is not
+    one. is_text is set for text logged while the DMA was sending."""
+    if len(record) < HEADER_SIZE:
+        return None
+
+    fmt_id, length, flags, timestamp = struct.unpack_from("<HBBI", record)
+    payload = record[HEADER_SIZE:]
+    if len(payload) != length:
+        return None
+
+    if fmt_id == FMT_TEXT:
+        return timestamp, flags & SEQ_MASK, payload.decode("latin-1"), True
+
+    fmt = format_string(logstr, fmt_id)
+    if fmt is None:
+        return None
+
+    if flags & FLAG_HEX:
+        text = render(fmt, [], " ".join("%02x" % b for b in payload))
+    else:
+        if length % 4:
+            return None
+        words = struct.unpack("<%dI" % (length // 4), payload)
+        text = render(fmt, words, None)
+
+    return timestamp, flags & SEQ_MASK, text, False
+
+
+def decode(logstr, capture, out, timestamps):
+    """Print the text and the decoded records of the capture in order."""
+    dropped = 0
+    prev_seq = None
+    text_open = False       # a text log continues in the next record
+
+    for chunk in capture.split(b"\0"):
+        if not chunk:
+            continue
+
+        frame = cobs_decode(chunk)
+        decoded = decode_record(logstr, frame) if frame is not None else None
+        if decoded is None:
+            out.write(chunk.decode("latin-1"))
+            continue
+
+        timestamp, seq, text, is_text = decoded
+        if prev_seq is not None and seq != ((prev_seq + 1) & SEQ_MASK):
+            lost = (seq - prev_seq - 1) & SEQ_MASK
+            dropped += lost
+            out.write("[%d records dropped]\n" % lost)
+        prev_seq = seq
+
+        if timestamps and not (is_text and text_open):
+            out.write("[%10.4f] " % (timestamp / RTC_HZ))
+        out.write(text)
+        text_open = is_text and not text.endswith("\n")
+
+    return dropped
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF file matching the capture")
+    parser.add_argument("capture", help="binary UART capture file, - for stdin")
+    parser.add_argument("--no-timestamp", action="store_true",
+                        help="do not prefix records with the RTC time (s)")
+    args = parser.parse_args()
+
+    try:
+        logstr = read_logstr(args.elf)
+    except (OSError, ValueError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    if args.capture == "-":
+        capture = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            capture = f.read()
+
+    dropped = decode(logstr, capture, sys.stdout, not args.no_timestamp)
+    if dropped:
+        print("warning: %d records dropped, the ring was full" % dropped,
+              file=sys.stderr)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Decode a power state recorder dump and report the duty cycle.
+
+The firmware dumps its power state recorder (code/power_recorder.c) through
+the trace UART as:
+
+    PWRREC H <now> <next seq> <count>
+    PWRREC E <timestamp> <state> <cause> <seq>      (count lines, oldest first)
+
+Timestamps are the lower 32 bits of the RTC cycle counter (32768 Hz). The RTC
+restarts from zero after a reset, recorded as a run entry with the reset
+cause; the time spent in the state before a reset is unknown and left out.
+Entries are sent a few at a time, feed a UART capture to this script; the last
+complete dump in it is analyzed.
+
+Usage:
+    power_trace_analyzer.py [--run-ua N] [--wfi-ua N] [--deep-ua N]
+                            [--noret-ua N] <capture file or ->
+"""
+
+import argparse
+import re
+import sys
+
+RTC_HZ = 32768.0
+
+STATES = {
+    0: "run",
+    1: "cpu sleep",
+    2: "deep sleep",
+    3: "deep sleep no retention",
+}
+
+CAUSE_RESET = 0x10
+
+CAUSES = (
+    (0x01, "rtc"),
+    (0x02, "bb timer"),
+    (0x04, "gpio1"),
+    (0x08, "irq"),
+    (CAUSE_RESET, "reset"),
+)
+
+HEADER_RE = re.compile(r"PWRREC H ([0-9a-fA-F]+) ([0-9a-fA-F]+) (\d+)")
+ENTRY_RE = re.compile(r"PWRREC E ([0-9a-fA-F]+) (\d+) ([0-9a-fA-F]+) ([0-9a-fA-F]+)")
+
+
+def read_last_dump(stream):
+    """Return (now, entries) of the last complete dump in the capture."""
+    dump = None
+    current = None
+
+    for line in stream:
+        m = HEADER_RE.search(line)
+        if m:
+            current = {"now": int(m.group(1), 16), "count": int(m.group(3)), "entries": []}
+            continue
+
+        m = ENTRY_RE.search(line)
+        if m and current is not None:
+            current["entries"].append((int(m.group(1), 16), int(m.group(2)),
+                                       int(m.group(3), 16), int(m.group(4), 16)))
+            if len(current["entries"]) == current["count"]:
+                dump = current
+                current = None
+
+    return dump
+
+
+def is_reset(entry):
+    return entry[1] == 0 and (entry[2] & CAUSE_RESET) != 0
+
+
+def durations(entries, now):
+    """Return the RTC cycles spent in the state of each entry.
+
+    Timestamps only increase, modulo 2^32, between two resets. The RTC
+    restarts at each reset entry, which starts a new segment: the time of the
+    entry before it is unknown and returned as None.
+    """
+    stamps = [e[0] for e in entries] + [now]
+    out = []
+    for i in range(len(entries)):
+        if i + 1 < len(entries) and is_reset(entries[i + 1]):
+            out.append(None)
+        else:
+            out.append((stamps[i + 1] - stamps[i]) & 0xFFFFFFFF)
+    return out
+
+
+def cause_name(cause):
+    names = [name for bit, name in CAUSES if cause & bit]
+    return "+".join(names) if names else "none"
+
+
+def analyze(dump, currents):
+    entries = dump["entries"]
+    times = durations(entries, dump["now"])
+
+    residency = {state: 0 for state in STATES}
+    wakeups = {}
+    lost = 0
+    resets = 0
+
+    for i, (_, state, cause, seq) in enumerate(entries):
+        if times[i] is None:
+            resets += 1
+        else:
+            residency[state] = residency.get(state, 0) + times[i]
+
+        if i and ((seq - entries[i - 1][3]) & 0xFFFF) != 1:
+            lost += ((seq - entries[i - 1][3]) & 0xFFFF) - 1
+
+        if state == 0 and i and entries[i - 1][1] != 0:
+            wakeups[cause_name(cause)] = wakeups.get(cause_name(cause), 0) + 1
+
+    total = sum(t for t in times if t is not None)
+    if total <= 0:
+        print("error: dump covers no time", file=sys.stderr)
+        return 1
+
+    hours = total / RTC_HZ / 3600.0
+    charge_uah = 0.0
+
+    print("Window: %.3f s, %d transitions, %d lost, %d resets"
+          % (total / RTC_HZ, len(entries), lost, resets))
+    print()
+    print("%-24s %12s %9s" % ("State", "Time (s)", "Share"))
+    for state, name in STATES.items():
+        seconds = residency.get(state, 0) / RTC_HZ
+        charge_uah += seconds * currents[state] / 3600.0
+        print("%-24s %12.3f %8.3f%%" % (name, seconds, 100.0 * residency.get(state, 0) / total))
+
+    print()
+    print("Duty cycle (run): %.3f%%" % (100.0 * residency[0] / total))
+    print()
+    print("%-24s %8s %12s" % ("Wakeup cause", "Count", "Per hour"))
+    for name, count in sorted(wakeups.items(), key=lambda kv: -kv[1]):
+        print("%-24s %8d %12.1f" % (name, count, count / hours))
+
+    print()
+    print("Estimated charge: %.3f uAh, average current %.3f uA"
+          % (charge_uah, charge_uah / hours))
+
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="UART capture file, - for stdin")
+    parser.add_argument("--run-ua", type=float, default=1000.0,
+                        help="current while running (uA)")
+    parser.add_argument("--wfi-ua", type=float, default=700.0,
+                        help="current in CPU sleep (uA)")
+    parser.add_argument("--deep-ua", type=float, default=1.5,
+                        help="current in sleep with core retention (uA)")
+    parser.add_argument("--noret-ua", type=float, default=0.4,
+                        help="current in sleep without core retention (uA)")
+    args = parser.parse_args()
+
+    if args.capture == "-":
+        dump = read_last_dump(sys.stdin)
+    else:
+        with open(args.capture, errors="replace") as f:
+            dump = read_last_dump(f)
+
+    if dump is None:
+        print("error: no complete PWRREC dump found", file=sys.stderr)
+        return 1
+
+    currents = {0: args.run_ua, 1: args.wfi_ua, 2: args.deep_ua, 3: args.noret_ua}
+    return analyze(dump, currents)
+
+
+if __name__ == "__main__":
+    sys.exit(main())